@@ -1,6 +1,9 @@
 #include "my_application.h"
 
+#include "window_plus/window_plus_plugin.h"
+
 int main(int argc, char** argv) {
+  window_plus_plugin_ensure_single_instance(APPLICATION_ID, argc, argv);
   g_autoptr(MyApplication) app = my_application_new();
   return g_application_run(G_APPLICATION(app), argc, argv);
 }
@@ -63,6 +63,7 @@ static void my_application_window_new(GApplication* application) {
   FlView* view = fl_view_new(project);
   gtk_widget_realize(GTK_WIDGET(view));
   gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
+  window_plus_plugin_set_application(APPLICATION_ID);
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 }
 
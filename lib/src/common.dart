@@ -3,6 +3,7 @@ import 'package:win32/win32.dart';
 // ignore_for_file: constant_identifier_names
 
 const String kMethodChannelName = 'com.alexmercerind/window_plus';
+const String kEventChannelName = 'com.alexmercerind/window_plus/events';
 
 // Common:
 
@@ -13,6 +14,10 @@ const String kWindowCloseReceivedMethodName = 'windowCloseReceived';
 const String kNotifyFirstFrameRasterizedMethodName = 'notifyFirstFrameRasterized';
 const String kSingleInstanceDataReceivedMethodName = 'singleInstanceDataReceived';
 const String kGetStateMethodName = 'getState';
+const String kGetSavedWindowStateMethodName = 'getSavedWindowState';
+const String kGetStartupProfileMethodName = 'getStartupProfile';
+const String kSubscribeEventsMethodName = 'subscribeEvents';
+const String kUnsubscribeEventsMethodName = 'unsubscribeEvents';
 const String kCloseMethodName = 'close';
 const String kDestroyMethodName = 'destroy';
 const String kGetIsMinimizedMethodName = 'getMinimized';
@@ -29,6 +34,11 @@ const String kMoveMethodName = 'move';
 const String kResizeMethodName = 'resize';
 const String kHideMethodName = 'hide';
 const String kShowMethodName = 'show';
+const String kGetDroppedEventCountMethodName = 'getDroppedEventCount';
+const String kNotifyFrameBuiltMethodName = 'notifyFrameBuilt';
+const String kNotifyFrameRasterizedMethodName = 'notifyFrameRasterized';
+const String kGetMismatchedResizeFrameCountMethodName = 'getMismatchedResizeFrameCount';
+const String kApplyWindowTransactionMethodName = 'applyWindowTransaction';
 
 // macOS Exclusives:
 
@@ -43,8 +53,46 @@ const String kWindowFullScreenMethodName = 'windowFullScreen';
 
 // GTK Exclusives:
 
-const String kWindowStateEventReceivedMethodName = 'windowStateEventReceived';
-const String kConfigureEventReceivedMethodName = 'configureEventReceived';
+const String kMonitorsChangedMethodName = 'monitorsChanged';
+const String kSetCaptionRegionsMethodName = 'setCaptionRegions';
+
+// Caption metrics of the GTK custom frame, in logical pixels.
+
+const double kGTKCaptionHeight = 32.0;
+const double kGTKCaptionButtonWidth = 46.0;
+
+const int kWindowStateEventType = 0;
+const int kConfigureEventType = 1;
+const int kResizeStartedEventType = 2;
+const int kResizeEndedEventType = 3;
+const int kMoveStartedEventType = 4;
+const int kMoveEndedEventType = 5;
+const int kFrameTimingEventType = 6;
+
+const int kWindowStateMinimized = 1 << 0;
+const int kWindowStateMaximized = 1 << 1;
+const int kWindowStateFullscreen = 1 << 2;
+const int kWindowStateFocused = 1 << 3;
+const int kWindowStateTiled = 1 << 4;
+const int kWindowStateAbove = 1 << 5;
+const int kWindowStateOccluded = 1 << 6;
+
+// GTK Event Record Layout (little-endian):
+
+const int kEventRecordSize = 64;
+const int kEventRecordTypeOffset = 0;
+const int kEventRecordStateOffset = 4;
+const int kEventRecordSequenceOffset = 8;
+const int kEventRecordTimestampOffset = 16;
+const int kEventRecordXOffset = 24;
+const int kEventRecordYOffset = 28;
+const int kEventRecordWidthOffset = 32;
+const int kEventRecordHeightOffset = 36;
+const int kEventRecordChangedOffset = 40;
+const int kEventRecordFrameLeftOffset = 48;
+const int kEventRecordFrameTopOffset = 52;
+const int kEventRecordFrameRightOffset = 56;
+const int kEventRecordFrameBottomOffset = 60;
 
 // Win32 Constants:
 
@@ -3,6 +3,14 @@ import 'package:flutter/rendering.dart';
 class Monitor {
   final Rect workarea;
   final Rect bounds;
+  final double scaleFactor;
+  // In Hertz, `0.0` if unknown.
+  final double refreshRate;
 
-  Monitor(this.workarea, this.bounds);
+  Monitor(
+    this.workarea,
+    this.bounds, {
+    this.scaleFactor = 1.0,
+    this.refreshRate = 0.0,
+  });
 }
@@ -0,0 +1,30 @@
+/// Launch of a secondary instance, forwarded to the primary instance.
+class SingleInstanceLaunch {
+  /// Command-line arguments, without the binary name.
+  final List<String> arguments;
+
+  /// Working directory of the secondary instance, `null` if unknown.
+  final String? workingDirectory;
+
+  /// Startup notification related environment variables of the secondary instance e.g. `DESKTOP_STARTUP_ID` & `XDG_ACTIVATION_TOKEN`.
+  final Map<String, String> environment;
+
+  const SingleInstanceLaunch(
+    this.arguments,
+    this.workingDirectory,
+    this.environment,
+  );
+
+  factory SingleInstanceLaunch.fromJson(dynamic json) => SingleInstanceLaunch(
+        List<String>.from(json['arguments']),
+        json['workingDirectory'],
+        Map<String, String>.from(json['environment'] ?? {}),
+      );
+
+  @override
+  String toString() => 'SingleInstanceLaunch('
+      'arguments: $arguments, '
+      'workingDirectory: $workingDirectory, '
+      'environment: $environment'
+      ')';
+}
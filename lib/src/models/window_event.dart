@@ -0,0 +1,54 @@
+/// Type of a native [WindowEvent].
+enum WindowEventType {
+  /// Minimized, maximized or fullscreen state changed.
+  windowState,
+
+  /// Position or size changed.
+  configure,
+
+  /// Window close button was pressed.
+  close,
+
+  /// Arguments were received from another instance.
+  singleInstance,
+
+  /// Interactive resize started.
+  resizeStarted,
+
+  /// Interactive resize ended.
+  resizeEnded,
+
+  /// Interactive move started.
+  moveStarted,
+
+  /// Interactive move ended.
+  moveEnded,
+
+  /// Frame presented or moved to another monitor.
+  frameTiming,
+}
+
+/// Ordering & timing information of a native window event.
+class WindowEvent {
+  final WindowEventType type;
+
+  /// Per-window sequence number, strictly increasing in the order the events were received natively.
+  final int sequence;
+
+  /// Monotonic time in microseconds at which the event was received natively.
+  /// Compare with `PlatformWindow.monotonicTime` to measure the delivery latency.
+  final int timestamp;
+
+  const WindowEvent(
+    this.type,
+    this.sequence,
+    this.timestamp,
+  );
+
+  @override
+  String toString() => 'WindowEvent('
+      'type: $type, '
+      'sequence: $sequence, '
+      'timestamp: $timestamp'
+      ')';
+}
@@ -0,0 +1,13 @@
+/// Policy used for coalescing window configure events (position & size changes) before they are delivered to the event streams.
+///
+/// Keep the order in sync with the native implementation(s).
+enum WindowEventCoalescing {
+  /// Every native event is delivered.
+  none,
+
+  /// At most one event is delivered per frame clock update, the latest geometry wins.
+  frame,
+
+  /// At most `eventCoalescingRate` events are delivered per second, the latest geometry wins.
+  rate,
+}
@@ -0,0 +1,30 @@
+/// Frame timing of the window, for pacing animations to the refresh rate of the monitor it is currently on.
+class WindowFrameTiming {
+  /// Index of the window's monitor in `PlatformWindow.monitors`, `-1` if unknown.
+  final int monitor;
+
+  /// Refresh interval of the window's monitor, [Duration.zero] if unknown.
+  final Duration refreshInterval;
+
+  /// Monotonic time in microseconds at which the last frame was (or is predicted to be) presented on the screen.
+  /// Same clock as `PlatformWindow.monotonicTime`.
+  final int presentationTime;
+
+  /// Whether the window moved to another monitor since the last [WindowFrameTiming].
+  final bool monitorChanged;
+
+  const WindowFrameTiming(
+    this.monitor,
+    this.refreshInterval,
+    this.presentationTime,
+    this.monitorChanged,
+  );
+
+  @override
+  String toString() => 'WindowFrameTiming('
+      'monitor: $monitor, '
+      'refreshInterval: $refreshInterval, '
+      'presentationTime: $presentationTime, '
+      'monitorChanged: $monitorChanged'
+      ')';
+}
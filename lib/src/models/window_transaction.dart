@@ -0,0 +1,45 @@
+import 'package:flutter/rendering.dart';
+
+/// A batch of window operations, applied together using [PlatformWindow.applyWindowTransaction].
+///
+/// Only the non-`null` fields are applied. Where supported, the window is moved, resized & its state is changed at once, avoiding the
+/// intermediate states & the extra layouts caused by separate calls to `move`, `resize`, `setMinimumSize`, `maximize` etc.
+class WindowTransaction {
+  final Offset? position;
+  final Size? size;
+  final Size? minimumSize;
+  final bool? maximized;
+  final bool? fullscreen;
+  final bool? minimized;
+
+  const WindowTransaction({
+    this.position,
+    this.size,
+    this.minimumSize,
+    this.maximized,
+    this.fullscreen,
+    this.minimized,
+  });
+
+  @override
+  String toString() => 'WindowTransaction('
+      'position: $position, '
+      'size: $size, '
+      'minimumSize: $minimumSize, '
+      'maximized: $maximized, '
+      'fullscreen: $fullscreen, '
+      'minimized: $minimized'
+      ')';
+
+  Map<String, dynamic> toJson() => {
+        if (position != null) 'x': position!.dx.toInt(),
+        if (position != null) 'y': position!.dy.toInt(),
+        if (size != null) 'width': size!.width.toInt(),
+        if (size != null) 'height': size!.height.toInt(),
+        if (minimumSize != null) 'minimumWidth': minimumSize!.width.toInt(),
+        if (minimumSize != null) 'minimumHeight': minimumSize!.height.toInt(),
+        if (maximized != null) 'maximized': maximized,
+        if (fullscreen != null) 'fullscreen': fullscreen,
+        if (minimized != null) 'minimized': minimized,
+      };
+}
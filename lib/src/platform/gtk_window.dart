@@ -1,56 +1,164 @@
+import 'dart:ffi' hide Size;
+import 'dart:ui' show FramePhase, FrameTiming;
 import 'dart:async';
+import 'dart:typed_data';
+import 'package:ffi/ffi.dart';
 import 'package:flutter/services.dart';
 import 'package:flutter/rendering.dart';
+import 'package:flutter/widgets.dart';
 
 import 'package:window_plus/src/common.dart';
 import 'package:window_plus/src/models/monitor.dart';
+import 'package:window_plus/src/models/window_event.dart';
+import 'package:window_plus/src/models/window_frame_timing.dart';
+import 'package:window_plus/src/models/single_instance_launch.dart';
 import 'package:window_plus/src/platform/platform_window.dart';
+import 'package:window_plus/src/models/window_transaction.dart';
 
 class GTKWindow extends PlatformWindow {
   GTKWindow({
     required super.application,
     required super.enableCustomFrame,
     required super.enableEventStreams,
-  });
+    super.eventCoalescing,
+    super.eventCoalescingRate,
+    super.pauseWhenOccluded,
+  }) {
+    ServicesBinding.instance.defaultBinaryMessenger.setMessageHandler(kEventChannelName, eventHandler);
+  }
 
-  @override
-  Future<dynamic> methodCallHandler(MethodCall call) async {
-    switch (call.method) {
-      case kWindowStateEventReceivedMethodName:
-        {
-          try {
-            minimizedStreamController.add(
-              call.arguments['minimized'],
-            );
-            maximizedStreamController.add(
-              call.arguments['maximized'],
-            );
-            fullscreenStreamController.add(
-              call.arguments['fullscreen'],
-            );
-          } catch (exception, stacktrace) {
-            debugPrint(exception.toString());
-            debugPrint(stacktrace.toString());
+  /// Decodes the fixed-layout event records sent by the native side over [kEventChannelName].
+  Future<ByteData?> eventHandler(ByteData? data) async {
+    if (data == null || data.lengthInBytes < kEventRecordSize) {
+      return null;
+    }
+    try {
+      final type = data.getInt32(kEventRecordTypeOffset, Endian.little);
+      final sequence = data.getInt64(kEventRecordSequenceOffset, Endian.little);
+      final timestamp = data.getInt64(kEventRecordTimestampOffset, Endian.little);
+      switch (type) {
+        case kWindowStateEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.windowState, sequence, timestamp));
+            final state = data.getUint32(kEventRecordStateOffset, Endian.little);
+            final changed = data.getUint32(kEventRecordChangedOffset, Endian.little);
+            // Only notify the listeners of the changed flags.
+            if (changed & kWindowStateMinimized != 0) {
+              minimizedStreamController.add(state & kWindowStateMinimized != 0);
+            }
+            if (changed & kWindowStateMaximized != 0) {
+              maximizedStreamController.add(state & kWindowStateMaximized != 0);
+            }
+            if (changed & kWindowStateFullscreen != 0) {
+              fullscreenStreamController.add(state & kWindowStateFullscreen != 0);
+            }
+            if (changed & kWindowStateFocused != 0) {
+              activatedStreamController.add(state & kWindowStateFocused != 0);
+            }
+            if (changed & kWindowStateTiled != 0) {
+              tiledStreamController.add(state & kWindowStateTiled != 0);
+            }
+            if (changed & kWindowStateAbove != 0) {
+              alwaysOnTopStreamController.add(state & kWindowStateAbove != 0);
+            }
+            if (changed & kWindowStateOccluded != 0) {
+              occludedStreamController.add(state & kWindowStateOccluded != 0);
+            }
+            break;
           }
-          break;
-        }
-      case kConfigureEventReceivedMethodName:
-        {
-          try {
+        case kConfigureEventType:
+          {
+            // Discard stale geometry i.e. older than the last delivered one.
+            if (sequence <= _lastConfigureEventSequence) {
+              break;
+            }
+            _lastConfigureEventSequence = sequence;
+            eventStreamController.add(WindowEvent(WindowEventType.configure, sequence, timestamp));
+            final x = data.getInt32(kEventRecordXOffset, Endian.little);
+            final y = data.getInt32(kEventRecordYOffset, Endian.little);
+            final width = data.getInt32(kEventRecordWidthOffset, Endian.little);
+            final height = data.getInt32(kEventRecordHeightOffset, Endian.little);
             positionStreamController.add(
               Offset(
-                call.arguments['position']['x'] * 1.0,
-                call.arguments['position']['y'] * 1.0,
+                x.toDouble(),
+                y.toDouble(),
               ),
             );
             sizeStreamController.add(
               Rect.fromLTWH(
-                call.arguments['size']['left'] * 1.0,
-                call.arguments['size']['top'] * 1.0,
-                call.arguments['size']['width'] * 1.0,
-                call.arguments['size']['height'] * 1.0,
+                x.toDouble(),
+                y.toDouble(),
+                width.toDouble(),
+                height.toDouble(),
+              ),
+            );
+            frameExtentsStreamController.add(
+              EdgeInsets.fromLTRB(
+                data.getInt32(kEventRecordFrameLeftOffset, Endian.little).toDouble(),
+                data.getInt32(kEventRecordFrameTopOffset, Endian.little).toDouble(),
+                data.getInt32(kEventRecordFrameRightOffset, Endian.little).toDouble(),
+                data.getInt32(kEventRecordFrameBottomOffset, Endian.little).toDouble(),
               ),
             );
+            break;
+          }
+        case kResizeStartedEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.resizeStarted, sequence, timestamp));
+            resizingStreamController.add(true);
+            break;
+          }
+        case kResizeEndedEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.resizeEnded, sequence, timestamp));
+            resizingStreamController.add(false);
+            break;
+          }
+        case kMoveStartedEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.moveStarted, sequence, timestamp));
+            movingStreamController.add(true);
+            break;
+          }
+        case kMoveEndedEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.moveEnded, sequence, timestamp));
+            movingStreamController.add(false);
+            break;
+          }
+        case kFrameTimingEventType:
+          {
+            eventStreamController.add(WindowEvent(WindowEventType.frameTiming, sequence, timestamp));
+            frameTimingStreamController.add(
+              WindowFrameTiming(
+                data.getInt32(kEventRecordXOffset, Endian.little),
+                Duration(microseconds: data.getInt32(kEventRecordWidthOffset, Endian.little)),
+                timestamp,
+                data.getUint32(kEventRecordChangedOffset, Endian.little) != 0,
+              ),
+            );
+            break;
+          }
+        default:
+          {
+            debugPrint('Unknown event type: $type');
+            break;
+          }
+      }
+    } catch (exception, stacktrace) {
+      debugPrint(exception.toString());
+      debugPrint(stacktrace.toString());
+    }
+    return null;
+  }
+
+  @override
+  Future<dynamic> methodCallHandler(MethodCall call) async {
+    switch (call.method) {
+      case kMonitorsChangedMethodName:
+        {
+          try {
+            monitorsStreamController.add(_monitorsFromValue(call.arguments));
           } catch (exception, stacktrace) {
             debugPrint(exception.toString());
             debugPrint(stacktrace.toString());
@@ -60,9 +168,16 @@ class GTKWindow extends PlatformWindow {
       case kSingleInstanceDataReceivedMethodName:
         {
           try {
-            singleInstanceArgumentsHandler?.call(
-              List<String>.from(call.arguments),
-            );
+            eventStreamController.add(WindowEvent(WindowEventType.singleInstance, call.arguments['sequence'], call.arguments['timestamp']));
+            // Launches arriving together are batched natively.
+            final launches = (call.arguments['launches'] as List).map((e) => SingleInstanceLaunch.fromJson(e)).toList();
+            if (singleInstanceLaunchesHandler != null) {
+              singleInstanceLaunchesHandler?.call(launches);
+            } else {
+              for (final launch in launches) {
+                singleInstanceArgumentsHandler?.call(launch.arguments);
+              }
+            }
           } catch (exception, stacktrace) {
             debugPrint(exception.toString());
             debugPrint(stacktrace.toString());
@@ -72,12 +187,12 @@ class GTKWindow extends PlatformWindow {
       case kWindowCloseReceivedMethodName:
         {
           try {
-            await save();
+            eventStreamController.add(WindowEvent(WindowEventType.close, call.arguments['sequence'], call.arguments['timestamp']));
           } catch (exception, stacktrace) {
             debugPrint(exception.toString());
             debugPrint(stacktrace.toString());
           }
-
+          // The window state is saved natively when the window is destroyed.
           final result = (await windowCloseHandler?.call()) ?? true;
           if (result) {
             destroy();
@@ -93,62 +208,181 @@ class GTKWindow extends PlatformWindow {
     }
   }
 
+  @override
+  Future<void> subscribeEvents(int type) async {
+    if (!enableEventStreams) {
+      return;
+    }
+    await channel.invokeMethod(
+      kSubscribeEventsMethodName,
+      {
+        'type': type,
+      },
+    );
+  }
+
+  @override
+  Future<void> unsubscribeEvents(int type) async {
+    if (!enableEventStreams) {
+      return;
+    }
+    await channel.invokeMethod(
+      kUnsubscribeEventsMethodName,
+      {
+        'type': type,
+      },
+    );
+  }
+
+  @override
+  Future<bool> get activated async {
+    ensureHandleAvailable();
+    return _readStateSnapshot((snapshot) => snapshot.state & kWindowStateFocused != 0);
+  }
+
+  @override
+  Future<bool> get alwaysOnTop async {
+    ensureHandleAvailable();
+    return _readStateSnapshot((snapshot) => snapshot.state & kWindowStateAbove != 0);
+  }
+
   @override
   Future<bool> get minimized async {
     ensureHandleAvailable();
-    return await channel.invokeMethod(kGetIsMinimizedMethodName);
+    return _readStateSnapshot((snapshot) => snapshot.state & kWindowStateMinimized != 0);
   }
 
   @override
   Future<bool> get maximized async {
     ensureHandleAvailable();
-    return await channel.invokeMethod(kGetIsMaximizedMethodName);
+    return _readStateSnapshot((snapshot) => snapshot.state & kWindowStateMaximized != 0);
   }
 
   @override
   Future<Size> get minimumSize async {
     ensureHandleAvailable();
-    final result = await channel.invokeMethod(
-      kGetMinimumSizeMethodName,
-    );
-    return Size(
-      (result['width'] as int).toDouble(),
-      (result['height'] as int).toDouble(),
+    return _readStateSnapshot(
+      (snapshot) => Size(
+        snapshot.minimumWidth.toDouble(),
+        snapshot.minimumHeight.toDouble(),
+      ),
     );
   }
 
   @override
   Future<bool> get fullscreen async {
     ensureHandleAvailable();
-    return await channel.invokeMethod(kGetIsFullscreenMethodName);
+    return _readStateSnapshot((snapshot) => snapshot.state & kWindowStateFullscreen != 0);
   }
 
   @override
   Future<Offset> get position async {
     ensureHandleAvailable();
-    final position = await channel.invokeMethod(
-      kGetPositionMethodName,
-    );
-    return Offset(
-      position['dx'] * 1.0,
-      position['dy'] * 1.0,
+    return _readStateSnapshot(
+      (snapshot) => Offset(
+        snapshot.x.toDouble(),
+        snapshot.y.toDouble(),
+      ),
     );
   }
 
   @override
   Future<Rect> get size async {
     ensureHandleAvailable();
-    final size = await channel.invokeMethod(
-      kGetSizeMethodName,
-    );
-    return Rect.fromLTWH(
-      size['left'] * 1.0,
-      size['top'] * 1.0,
-      size['width'] * 1.0,
-      size['height'] * 1.0,
+    return _readStateSnapshot(
+      (snapshot) => Rect.fromLTWH(
+        0.0,
+        0.0,
+        snapshot.width.toDouble(),
+        snapshot.height.toDouble(),
+      ),
     );
   }
 
+  @override
+  Future<int> get droppedEventCount async {
+    ensureHandleAvailable();
+    return await channel.invokeMethod(kGetDroppedEventCountMethodName);
+  }
+
+  @override
+  Future<int> get mismatchedResizeFrameCount async {
+    ensureHandleAvailable();
+    return await channel.invokeMethod(kGetMismatchedResizeFrameCountMethodName);
+  }
+
+  @override
+  Future<void> ensureInitialized() async {
+    await super.ensureInitialized();
+    // Persistent frame callbacks cannot be removed, add them once.
+    if (_frameCallbacksAdded) return;
+    _frameCallbacksAdded = true;
+    WidgetsBinding.instance.addPersistentFrameCallback(_frameCallback);
+    WidgetsBinding.instance.addTimingsCallback(_timingsCallback);
+  }
+
+  /// Reports every frame built at a new size, the native side keeps the window manager waiting for it during a resize. The frame is only
+  /// rasterized afterwards, see [_timingsCallback].
+  void _frameCallback(Duration _) {
+    final size = WidgetsBinding.instance.platformDispatcher.implicitView?.physicalSize;
+    if (size == null || size == _frameSize) {
+      return;
+    }
+    _frameSize = size;
+    _frameSizes[WidgetsBinding.instance.platformDispatcher.frameData.frameNumber] = size;
+    WidgetsBinding.instance.addPostFrameCallback((_) async {
+      try {
+        await channel.invokeMethod(
+          kNotifyFrameBuiltMethodName,
+          {
+            'width': size.width.round(),
+            'height': size.height.round(),
+          },
+        );
+      } catch (exception, stacktrace) {
+        debugPrint(exception.toString());
+        debugPrint(stacktrace.toString());
+      }
+    });
+  }
+
+  /// Reports when the frames built at a new size finished rasterizing. [FramePhase.rasterFinish] is in microseconds of the monotonic clock
+  /// i.e. same as [monotonicTime]. The engine reports [FrameTiming]s in batches, so this usually arrives after the window is already shown.
+  void _timingsCallback(List<FrameTiming> timings) {
+    for (final timing in timings) {
+      final size = _frameSizes.remove(timing.frameNumber);
+      if (size == null) {
+        continue;
+      }
+      // Frames without timings (if any) are never reported.
+      _frameSizes.removeWhere((frameNumber, _) => frameNumber < timing.frameNumber);
+      _notifyFrameRasterized(size, timing.timestampInMicroseconds(FramePhase.rasterFinish));
+    }
+  }
+
+  Future<void> _notifyFrameRasterized(Size size, int rasterFinish) async {
+    try {
+      await channel.invokeMethod(
+        kNotifyFrameRasterizedMethodName,
+        {
+          'width': size.width.round(),
+          'height': size.height.round(),
+          'rasterFinish': rasterFinish,
+        },
+      );
+    } catch (exception, stacktrace) {
+      debugPrint(exception.toString());
+      debugPrint(stacktrace.toString());
+    }
+  }
+
+  @override
+  Future<Map<String, Duration>> get startupProfile async {
+    final result = Map<String, int>.from(await channel.invokeMethod(kGetStartupProfileMethodName));
+    final origin = result['registerWithRegistrar'] ?? 0;
+    return result.map((key, value) => MapEntry(key, Duration(microseconds: value - origin)));
+  }
+
   @override
   Future<void> setIsFullscreen(bool enabled) async {
     ensureHandleAvailable();
@@ -243,10 +477,92 @@ class GTKWindow extends PlatformWindow {
     await channel.invokeMethod(kShowMethodName);
   }
 
+  @override
+  Future<void> applyWindowTransaction(WindowTransaction transaction) async {
+    ensureHandleAvailable();
+    await channel.invokeMethod(
+      kApplyWindowTransactionMethodName,
+      transaction.toJson(),
+    );
+  }
+
+  @override
+  void setCaptionRegion(int id, Rect rect, {bool drag = true}) {
+    _removedCaptionRegions.remove(id);
+    _changedCaptionRegions[id] = [
+      id,
+      drag ? 1 : 0,
+      rect.left.round(),
+      rect.top.round(),
+      rect.width.round(),
+      rect.height.round(),
+    ];
+    _scheduleCaptionRegionsUpdate();
+  }
+
+  @override
+  void removeCaptionRegion(int id) {
+    _changedCaptionRegions.remove(id);
+    _removedCaptionRegions.add(id);
+    _scheduleCaptionRegionsUpdate();
+  }
+
+  /// Sends all the caption regions changed within the current frame together, only the changed ones.
+  void _scheduleCaptionRegionsUpdate() {
+    if (_captionRegionsUpdateScheduled) {
+      return;
+    }
+    _captionRegionsUpdateScheduled = true;
+    scheduleMicrotask(() async {
+      _captionRegionsUpdateScheduled = false;
+      final regions = Int32List.fromList(_changedCaptionRegions.values.expand((e) => e).toList());
+      final removed = Int32List.fromList(_removedCaptionRegions.toList());
+      _changedCaptionRegions.clear();
+      _removedCaptionRegions.clear();
+      try {
+        await channel.invokeMethod(
+          kSetCaptionRegionsMethodName,
+          {
+            'regions': regions,
+            'removed': removed,
+          },
+        );
+      } catch (exception, stacktrace) {
+        debugPrint(exception.toString());
+        debugPrint(stacktrace.toString());
+      }
+    });
+  }
+
   @override
   Future<List<Monitor>> get monitors async {
     ensureHandleAvailable();
     final monitors = await channel.invokeMethod(kGetMonitorsMethodName);
+    return _monitorsFromValue(monitors);
+  }
+
+  @override
+  double get captionPadding {
+    return 0.0;
+  }
+
+  @override
+  double get captionHeight {
+    if (enableCustomFrame) {
+      return kGTKCaptionHeight;
+    }
+    return 0.0;
+  }
+
+  @override
+  Size get captionButtonSize {
+    if (enableCustomFrame) {
+      return const Size(kGTKCaptionButtonWidth, kGTKCaptionHeight);
+    }
+    return Size.zero;
+  }
+
+  List<Monitor> _monitorsFromValue(dynamic monitors) {
     return List<Monitor>.from(
       monitors.map(
         (monitor) => Monitor(
@@ -262,23 +578,75 @@ class GTKWindow extends PlatformWindow {
             monitor['bounds']['width'] * 1.0,
             monitor['bounds']['height'] * 1.0,
           ),
+          scaleFactor: monitor['scaleFactor'] * 1.0,
+          refreshRate: monitor['refreshRate'] * 1.0,
         ),
       ),
     );
   }
 
-  @override
-  double get captionPadding {
-    return 0.0;
+  /// Reads the native window state snapshot. The native side copies it consistently (sequence lock with acquire ordering) into [_stateSnapshot],
+  /// which is only ever accessed from here.
+  T _readStateSnapshot<T>(T Function(_StateSnapshot snapshot) reader) {
+    if (_copyStateSnapshot(handle, _stateSnapshot) == 0) {
+      throw StateError('window_plus_plugin_copy_state_snapshot_for_window: No window is registered for $handle.');
+    }
+    return reader(_stateSnapshot.ref);
   }
 
   @override
-  double get captionHeight {
-    return 0.0;
-  }
+  int get monotonicTime => _monotonicTime();
 
-  @override
-  Size get captionButtonSize {
-    return Size.zero;
-  }
+  int _lastConfigureEventSequence = 0;
+
+  bool _frameCallbacksAdded = false;
+
+  Size? _frameSize;
+
+  /// Sizes of the frames built at a new size by [FrameTiming.frameNumber], until their [FrameTiming] arrives.
+  final Map<int, Size> _frameSizes = <int, Size>{};
+
+  bool _captionRegionsUpdateScheduled = false;
+  final Map<int, List<int>> _changedCaptionRegions = <int, List<int>>{};
+  final Set<int> _removedCaptionRegions = <int>{};
+
+  late final int Function() _monotonicTime = DynamicLibrary.process().lookupFunction<Int64 Function(), int Function()>(
+        'window_plus_plugin_get_monotonic_time',
+      );
+
+  /// Copied by [handle], since the native symbols are shared by all the windows (engines) of the process.
+  late final int Function(int, Pointer<_StateSnapshot>) _copyStateSnapshot =
+      DynamicLibrary.process().lookupFunction<Int32 Function(Int64, Pointer<_StateSnapshot>), int Function(int, Pointer<_StateSnapshot>)>(
+    'window_plus_plugin_copy_state_snapshot_for_window',
+    isLeaf: true,
+  );
+
+  /// Allocated once & kept for the lifetime of the window.
+  late final Pointer<_StateSnapshot> _stateSnapshot = calloc<_StateSnapshot>();
+}
+
+/// Mirror of |WindowPlusStateSnapshot| in `linux/include/window_plus/window_plus_plugin.h`.
+class _StateSnapshot extends Struct {
+  @Uint32()
+  external int sequence;
+  @Uint32()
+  external int state;
+  @Int32()
+  external int x;
+  @Int32()
+  external int y;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int minimumWidth;
+  @Int32()
+  external int minimumHeight;
+  @Int32()
+  external int monitor;
+  @Int32()
+  external int reserved;
+  @Double()
+  external double scaleFactor;
 }
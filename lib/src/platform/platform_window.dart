@@ -2,14 +2,23 @@ import 'dart:ui';
 import 'dart:async';
 
 import 'package:meta/meta.dart';
+import 'package:flutter/painting.dart' show EdgeInsets;
+import 'package:window_plus/src/common.dart';
 import 'package:window_plus/src/window_state.dart';
 import 'package:window_plus/src/models/monitor.dart';
+import 'package:window_plus/src/models/window_event.dart';
+import 'package:window_plus/src/models/window_frame_timing.dart';
+import 'package:window_plus/src/models/single_instance_launch.dart';
+import 'package:window_plus/src/models/window_transaction.dart';
 
 class PlatformWindow extends WindowState {
   PlatformWindow({
     required super.application,
     required super.enableCustomFrame,
     required super.enableEventStreams,
+    super.eventCoalescing,
+    super.eventCoalescingRate,
+    super.pauseWhenOccluded,
   });
 
   Future<bool> get activated async {
@@ -44,6 +53,23 @@ class PlatformWindow extends WindowState {
     throw UnimplementedError();
   }
 
+  /// Number of native events dropped (coalesced) due to [eventCoalescing].
+  Future<int> get droppedEventCount async {
+    throw UnimplementedError();
+  }
+
+  /// Number of resizes shown by the window manager before a frame was rendered at the new size i.e. the resize synchronization timed out
+  /// (only on GNU/Linux with X11).
+  Future<int> get mismatchedResizeFrameCount async {
+    throw UnimplementedError();
+  }
+
+  /// Time taken to reach each of the native startup phases, relative to the plugin registration.
+  /// Phases which are not reached yet are absent.
+  Future<Map<String, Duration>> get startupProfile async {
+    throw UnimplementedError();
+  }
+
   Stream<bool> get activatedStream => activatedStreamController.stream;
 
   Stream<bool> get minimizedStream => minimizedStreamController.stream;
@@ -56,6 +82,40 @@ class PlatformWindow extends WindowState {
 
   Stream<Rect> get sizeStream => sizeStreamController.stream;
 
+  Stream<bool> get alwaysOnTopStream => alwaysOnTopStreamController.stream;
+
+  /// Client-side decoration (shadow & resize border) drawn around the window, emitted together with [sizeStream].
+  /// Always [EdgeInsets.zero] with server-side decorations (only on GNU/Linux).
+  Stream<EdgeInsets> get frameExtentsStream => frameExtentsStreamController.stream;
+
+  /// Whether the window is not visible at all i.e. minimized, withdrawn (e.g. on another workspace) or fully covered by other windows.
+  /// Covering windows are only detected on X11 without a compositing window manager (only on GNU/Linux).
+  Stream<bool> get occludedStream => occludedStreamController.stream;
+
+  /// Whether the window is tiled (e.g. snapped to a screen edge) by the window manager.
+  Stream<bool> get tiledStream => tiledStreamController.stream;
+
+  /// Whether the window is being interactively resized by the user. Emits `true` when a resize starts & `false` when it ends.
+  /// Useful for rendering cheap placeholders instead of re-laying out expensive content at every intermediate size.
+  Stream<bool> get resizingStream => resizingStreamController.stream;
+
+  /// Whether the window is being interactively moved by the user. Emits `true` when a move starts & `false` when it ends.
+  Stream<bool> get movingStream => movingStreamController.stream;
+
+  Stream<List<Monitor>> get monitorsStream => monitorsStreamController.stream;
+
+  /// Refresh interval & presentation time of every frame & the window's monitor, also emitted when the window moves to another monitor
+  /// (only on GNU/Linux).
+  Stream<WindowFrameTiming> get frameTimingStream => frameTimingStreamController.stream;
+
+  /// Ordering & timing information of every native window event, delivered before the event itself is handled.
+  Stream<WindowEvent> get eventStream => eventStreamController.stream;
+
+  /// Current native monotonic time in microseconds i.e. same clock as [WindowEvent.timestamp].
+  int get monotonicTime {
+    throw UnimplementedError();
+  }
+
   void setWindowCloseHandler(Future<bool> Function()? value) {
     windowCloseHandler = value;
   }
@@ -64,6 +124,12 @@ class PlatformWindow extends WindowState {
     singleInstanceArgumentsHandler = value;
   }
 
+  /// Sets the handler receiving the launches of secondary instances in batches i.e. all the launches arriving together (e.g. opening
+  /// many files at once) are received in a single call. Takes precedence over [setSingleInstanceArgumentsHandler] (only on GNU/Linux).
+  void setSingleInstanceLaunchesHandler(void Function(List<SingleInstanceLaunch>)? value) {
+    singleInstanceLaunchesHandler = value;
+  }
+
   Future<void> setIsAlwaysOnTop(bool enabled) async {
     throw UnimplementedError();
   }
@@ -120,6 +186,53 @@ class PlatformWindow extends WindowState {
     throw UnimplementedError();
   }
 
+  /// Sets the [rect] (in logical pixels, relative to the window's content) of the caption region [id]. Pressing inside a caption region
+  /// starts moving the window & double-clicking it maximizes or restores the window natively, without a round trip to Dart.
+  /// [drag] `false` makes it a no-drag region (e.g. the caption buttons), which takes precedence over the caption regions (only on GNU/Linux).
+  void setCaptionRegion(int id, Rect rect, {bool drag = true}) {}
+
+  /// Removes the caption region [id] set by [setCaptionRegion].
+  void removeCaptionRegion(int id) {}
+
+  /// Starts delivering the native events of [type] e.g. [kWindowStateEventType] or [kConfigureEventType].
+  /// Called when the first listener subscribes to any of the streams fed by them.
+  @protected
+  Future<void> subscribeEvents(int type) async {}
+
+  /// Stops delivering the native events of [type]. Called when the last listener of any of the streams fed by them cancels.
+  @protected
+  Future<void> unsubscribeEvents(int type) async {}
+
+  /// Applies all the operations of [transaction] together.
+  ///
+  /// Platforms without a native implementation apply the operations one after another.
+  Future<void> applyWindowTransaction(WindowTransaction transaction) async {
+    if (transaction.minimumSize != null) {
+      await setMinimumSize(transaction.minimumSize);
+    }
+    if (transaction.fullscreen == false) {
+      await setIsFullscreen(false);
+    }
+    if (transaction.maximized == false || transaction.minimized == false) {
+      await restore();
+    }
+    if (transaction.size != null) {
+      await resize(transaction.size!.width.toInt(), transaction.size!.height.toInt());
+    }
+    if (transaction.position != null) {
+      await move(transaction.position!.dx.toInt(), transaction.position!.dy.toInt());
+    }
+    if (transaction.maximized == true) {
+      await maximize();
+    }
+    if (transaction.fullscreen == true) {
+      await setIsFullscreen(true);
+    }
+    if (transaction.minimized == true) {
+      await minimize();
+    }
+  }
+
   Future<List<Monitor>> get monitors async {
     throw UnimplementedError();
   }
@@ -143,20 +256,89 @@ class PlatformWindow extends WindowState {
   void Function(List<String> arguments)? singleInstanceArgumentsHandler;
 
   @protected
-  StreamController<bool> activatedStreamController = StreamController<bool>.broadcast();
+  void Function(List<SingleInstanceLaunch> launches)? singleInstanceLaunchesHandler;
+
+  @protected
+  late StreamController<bool> activatedStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<bool> minimizedStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<bool> maximizedStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<bool> fullscreenStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<Offset> positionStreamController = StreamController<Offset>.broadcast(
+    onListen: () => subscribeEvents(kConfigureEventType),
+    onCancel: () => unsubscribeEvents(kConfigureEventType),
+  );
+
+  @protected
+  late StreamController<Rect> sizeStreamController = StreamController<Rect>.broadcast(
+    onListen: () => subscribeEvents(kConfigureEventType),
+    onCancel: () => unsubscribeEvents(kConfigureEventType),
+  );
+
+  @protected
+  late StreamController<EdgeInsets> frameExtentsStreamController = StreamController<EdgeInsets>.broadcast(
+    onListen: () => subscribeEvents(kConfigureEventType),
+    onCancel: () => unsubscribeEvents(kConfigureEventType),
+  );
+
+  @protected
+  late StreamController<bool> alwaysOnTopStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<bool> occludedStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
+
+  @protected
+  late StreamController<bool> tiledStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kWindowStateEventType),
+    onCancel: () => unsubscribeEvents(kWindowStateEventType),
+  );
 
   @protected
-  StreamController<bool> minimizedStreamController = StreamController<bool>.broadcast();
+  late StreamController<bool> resizingStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kResizeStartedEventType),
+    onCancel: () => unsubscribeEvents(kResizeStartedEventType),
+  );
 
   @protected
-  StreamController<bool> maximizedStreamController = StreamController<bool>.broadcast();
+  late StreamController<bool> movingStreamController = StreamController<bool>.broadcast(
+    onListen: () => subscribeEvents(kMoveStartedEventType),
+    onCancel: () => unsubscribeEvents(kMoveStartedEventType),
+  );
 
   @protected
-  StreamController<bool> fullscreenStreamController = StreamController<bool>.broadcast();
+  late StreamController<WindowFrameTiming> frameTimingStreamController = StreamController<WindowFrameTiming>.broadcast(
+    onListen: () => subscribeEvents(kFrameTimingEventType),
+    onCancel: () => unsubscribeEvents(kFrameTimingEventType),
+  );
 
   @protected
-  StreamController<Offset> positionStreamController = StreamController<Offset>.broadcast();
+  StreamController<List<Monitor>> monitorsStreamController = StreamController<List<Monitor>>.broadcast();
 
   @protected
-  StreamController<Rect> sizeStreamController = StreamController<Rect>.broadcast();
+  StreamController<WindowEvent> eventStreamController = StreamController<WindowEvent>.broadcast();
 }
@@ -0,0 +1,147 @@
+// ignore_for_file: prefer_const_constructors_in_immutables
+
+import 'package:flutter/material.dart';
+import 'package:flutter/rendering.dart';
+
+import 'package:window_plus/src/window_plus.dart';
+import 'package:window_plus/src/widgets/win32/widgets.dart' as win32;
+
+/// Marks its area as a part of the window caption i.e. pressing it starts moving the window & double-clicking it maximizes or restores
+/// the window. Handled natively on the first pointer event, without any gesture recognition in Flutter.
+///
+/// [drag] `false` marks a no-drag area (e.g. a button placed inside the caption), excluded from the enclosing caption areas.
+///
+/// Only has an effect on GNU/Linux.
+class WindowCaptionArea extends SingleChildRenderObjectWidget {
+  final bool drag;
+
+  WindowCaptionArea({
+    super.key,
+    super.child,
+    this.drag = true,
+  });
+
+  @override
+  RenderObject createRenderObject(BuildContext context) {
+    return _RenderWindowCaptionArea(drag: drag);
+  }
+
+  @override
+  void updateRenderObject(BuildContext context, covariant _RenderWindowCaptionArea renderObject) {
+    renderObject.drag = drag;
+  }
+}
+
+/// Sends its global bounds to the native side whenever they change, checked every time it is painted.
+class _RenderWindowCaptionArea extends RenderProxyBox {
+  static int _ids = 0;
+
+  final int _id = _ids++;
+  bool _drag;
+  Rect? _rect;
+
+  _RenderWindowCaptionArea({required bool drag}) : _drag = drag;
+
+  set drag(bool value) {
+    if (_drag == value) {
+      return;
+    }
+    _drag = value;
+    _rect = null;
+    markNeedsPaint();
+  }
+
+  @override
+  void paint(PaintingContext context, Offset offset) {
+    super.paint(context, offset);
+    final rect = localToGlobal(Offset.zero) & size;
+    if (rect != _rect) {
+      _rect = rect;
+      WindowPlus.instance.setCaptionRegion(_id, rect, drag: _drag);
+    }
+  }
+
+  @override
+  void detach() {
+    if (_rect != null) {
+      _rect = null;
+      WindowPlus.instance.removeCaptionRegion(_id);
+    }
+    super.detach();
+  }
+}
+
+class WindowCaption extends StatelessWidget {
+  final Widget? child;
+  final Brightness? brightness;
+  WindowCaption({super.key, this.child, this.brightness});
+
+  @override
+  Widget build(BuildContext context) {
+    if (!WindowPlus.instance.enableCustomFrame) {
+      return const SizedBox.shrink();
+    }
+    return FutureBuilder<bool>(
+      future: WindowPlus.instance.fullscreen,
+      builder: (context, snapshot) {
+        return snapshot.data == true
+            ? SizedBox(
+                width: double.infinity,
+                height: WindowPlus.instance.captionHeight,
+              )
+            : SizedBox(
+                width: double.infinity,
+                height: WindowPlus.instance.captionHeight,
+                child: Theme(
+                  data: Theme.of(context).copyWith(brightness: brightness),
+                  child: Row(
+                    mainAxisAlignment: MainAxisAlignment.end,
+                    crossAxisAlignment: CrossAxisAlignment.center,
+                    children: [
+                      Expanded(
+                        child: WindowCaptionArea(
+                          child: SizedBox(
+                            height: WindowPlus.instance.captionHeight,
+                            child: child,
+                          ),
+                        ),
+                      ),
+                      WindowCaptionArea(
+                        drag: false,
+                        child: Row(
+                          mainAxisSize: MainAxisSize.min,
+                          children: [
+                            win32.WindowMinimizeButton(),
+                            WindowRestoreMaximizeButton(),
+                            win32.WindowCloseButton(),
+                          ],
+                        ),
+                      ),
+                    ],
+                  ),
+                ),
+              );
+      },
+    );
+  }
+}
+
+class WindowRestoreMaximizeButton extends StatelessWidget {
+  WindowRestoreMaximizeButton({super.key});
+
+  @override
+  Widget build(BuildContext context) {
+    return FutureBuilder<bool>(
+      future: WindowPlus.instance.maximized,
+      builder: (context, snapshot) {
+        return StreamBuilder<bool>(
+          stream: WindowPlus.instance.maximizedStream,
+          initialData: snapshot.data ?? false,
+          builder: (context, snapshot) {
+            return snapshot.data == true ? win32.WindowRestoreButton() : win32.WindowMaximizeButton();
+          },
+        );
+      },
+    );
+  }
+}
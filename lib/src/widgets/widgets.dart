@@ -4,9 +4,12 @@ import 'dart:io';
 
 import 'package:flutter/material.dart';
 
+import 'gtk/widgets.dart' as gtk;
 import 'macos/widgets.dart' as macos;
 import 'win32/widgets.dart' as win32;
 
+export 'gtk/widgets.dart' show WindowCaptionArea;
+
 class WindowCaption extends StatelessWidget {
   final Widget? child;
   final Brightness? brightness;
@@ -21,6 +24,9 @@ class WindowCaption extends StatelessWidget {
     if (Platform.isWindows) {
       return win32.WindowCaption(brightness: brightness, child: child);
     }
+    if (Platform.isLinux) {
+      return gtk.WindowCaption(brightness: brightness, child: child);
+    }
     return const SizedBox.shrink();
   }
 }
@@ -5,6 +5,7 @@ import 'package:window_plus/src/platform/gtk_window.dart';
 import 'package:window_plus/src/platform/win32_window.dart';
 import 'package:window_plus/src/platform/platform_window.dart';
 import 'package:window_plus/src/utils/windows_info.dart';
+import 'package:window_plus/src/models/window_event_coalescing.dart';
 
 /// {@template window_plus}
 ///
@@ -28,15 +29,28 @@ class WindowPlus {
   /// * [enableCustomFrame] decides whether a custom window frame should be used or not. The default values for different platforms are:
   ///   * macOS:     Depends on the configured window style.
   ///   * Windows:   `true` if Windows 10 RTM i.e. version 1507 & build 10240 or greater, `false` otherwise.
-  ///   * GNU/Linux: `false` (too much nonsense with all the desktop environments).
+  ///   * GNU/Linux: `false` (too much nonsense with all the desktop environments). If `true`, the window is undecorated, resized from
+  ///                its edges natively & moved from the [WindowCaption] (or any [WindowCaptionArea]).
   ///
   /// * [enableEventStreams] argument decides whether event streams should be enabled for listening to window state changes e.g. minimize, maximize, restore, position, size, etc.
   ///   Disabling this may yield performance improvements. The default value is `true`.
+  ///   On GNU/Linux, the native event handlers are only connected while the respective streams have listeners.
+  ///
+  /// * [eventCoalescing] decides how position & size events are coalesced before being delivered to the event streams (only on GNU/Linux).
+  ///   * [WindowEventCoalescing.none]:  Every event is delivered. This is the default value.
+  ///   * [WindowEventCoalescing.frame]: At most one event is delivered per frame.
+  ///   * [WindowEventCoalescing.rate]:  At most [eventCoalescingRate] events are delivered per second. The default rate is `60`.
+  ///
+  /// * [pauseWhenOccluded] decides whether Flutter should also stop rendering frames while the window is fully covered by other windows &
+  ///   resume once it is exposed again (only on GNU/Linux with X11). Flutter already does so while minimized. The default value is `false`.
   ///
   static Future<void> ensureInitialized({
     required String application,
     bool? enableCustomFrame,
     bool? enableEventStreams,
+    WindowEventCoalescing? eventCoalescing,
+    int? eventCoalescingRate,
+    bool? pauseWhenOccluded,
   }) async {
     if (initialized) return;
     initialized = true;
@@ -61,6 +75,9 @@ class WindowPlus {
         application: application,
         enableCustomFrame: enableCustomFrame,
         enableEventStreams: enableEventStreams,
+        eventCoalescing: eventCoalescing ?? WindowEventCoalescing.none,
+        eventCoalescingRate: eventCoalescingRate ?? 60,
+        pauseWhenOccluded: pauseWhenOccluded ?? false,
       );
       await instance.ensureInitialized();
     }
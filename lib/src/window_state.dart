@@ -9,16 +9,23 @@ import 'package:safe_local_storage/safe_local_storage.dart';
 
 import 'package:window_plus/src/common.dart';
 import 'package:window_plus/src/models/saved_window_state.dart';
+import 'package:window_plus/src/models/window_event_coalescing.dart';
 
 class WindowState {
   final String application;
   final bool enableCustomFrame;
   final bool enableEventStreams;
+  final WindowEventCoalescing eventCoalescing;
+  final int eventCoalescingRate;
+  final bool pauseWhenOccluded;
 
   WindowState({
     required this.application,
     required this.enableCustomFrame,
     required this.enableEventStreams,
+    this.eventCoalescing = WindowEventCoalescing.none,
+    this.eventCoalescingRate = 60,
+    this.pauseWhenOccluded = false,
   }) {
     channel.setMethodCallHandler(methodCallHandler);
   }
@@ -28,9 +35,14 @@ class WindowState {
       handle = await channel.invokeMethod(
         kEnsureInitializedMethodName,
         {
+          'application': application,
           'enableCustomFrame': enableCustomFrame,
           'enableEventStreams': enableEventStreams,
-          'savedWindowState': (await savedWindowState)?.toJson(),
+          'eventCoalescing': eventCoalescing.index,
+          'eventCoalescingRate': eventCoalescingRate,
+          'pauseWhenOccluded': pauseWhenOccluded,
+          // On GNU/Linux, the saved window state is read & applied natively.
+          'savedWindowState': Platform.isLinux ? null : (await savedWindowState)?.toJson(),
         },
       );
     } catch (_) {}
@@ -40,7 +52,9 @@ class WindowState {
         await channel.invokeMethod(
           kNotifyFirstFrameRasterizedMethodName,
           {
-            'savedWindowState': (await savedWindowState)?.toJson(),
+            'savedWindowState': Platform.isLinux ? null : (await savedWindowState)?.toJson(),
+            'width': WidgetsBinding.instance.platformDispatcher.implicitView?.physicalSize.width.round(),
+            'height': WidgetsBinding.instance.platformDispatcher.implicitView?.physicalSize.height.round(),
           },
         );
       } catch (_) {}
@@ -75,19 +89,17 @@ class WindowState {
         debugPrint(result.toString());
       }
     } else if (Platform.isLinux) {
-      final result = await channel.invokeMethod(
-        kGetStateMethodName,
-        {
-          'savedWindowState': (await savedWindowState)?.toJson(),
-        },
-      );
-      await storage.write(result);
-      debugPrint(result.toString());
+      // NO/OP: The window state is saved natively whenever it changes & when the window is destroyed.
     }
   }
 
   Future<SavedWindowState?> get savedWindowState async {
     try {
+      if (Platform.isLinux) {
+        // Already read & parsed natively, see [kGetSavedWindowStateMethodName].
+        final data = await channel.invokeMethod(kGetSavedWindowStateMethodName);
+        return data == null ? null : SavedWindowState.fromJson(data);
+      }
       final data = await storage.read();
       return SavedWindowState.fromJson(data);
     } catch (_) {}
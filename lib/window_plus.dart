@@ -1,2 +1,7 @@
 export 'package:window_plus/src/window_plus.dart';
+export 'package:window_plus/src/models/single_instance_launch.dart';
+export 'package:window_plus/src/models/window_event.dart';
+export 'package:window_plus/src/models/window_event_coalescing.dart';
+export 'package:window_plus/src/models/window_frame_timing.dart';
+export 'package:window_plus/src/models/window_transaction.dart';
 export 'package:window_plus/src/widgets/widgets.dart';
@@ -16,14 +16,58 @@ typedef struct {
   GObjectClass parent_class;
 } WindowPlusPluginClass;
 
+// Snapshot of the window state, kept up to date by the plugin & read synchronously from Dart through FFI, see
+// |window_plus_plugin_copy_state_snapshot_for_window|. |sequence| is the (even) value of the plugin's sequence lock for the copy.
+typedef struct {
+  uint32_t sequence;
+  // Bit-mask of |kWindowState*| values.
+  uint32_t state;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  int32_t minimum_width;
+  int32_t minimum_height;
+  // Index of the monitor the window is present on, -1 if unknown.
+  int32_t monitor;
+  int32_t reserved;
+  double scale_factor;
+} WindowPlusStateSnapshot;
+
 FLUTTER_PLUGIN_EXPORT GType window_plus_plugin_get_type();
 
 FLUTTER_PLUGIN_EXPORT void window_plus_plugin_register_with_registrar(
     FlPluginRegistrar* registrar);
 
+// Sets the application identifier i.e. same as the |application| passed to |WindowPlus.ensureInitialized| in Dart.
+// If called before |fl_register_plugins|, the saved window state is read from ~/.config/<application>/WindowState.JSON & applied
+// before the Dart VM starts. Otherwise, it is applied when |WindowPlus.ensureInitialized| is called.
+FLUTTER_PLUGIN_EXPORT void window_plus_plugin_set_application(
+    const gchar* application);
+
 FLUTTER_PLUGIN_EXPORT void window_plus_plugin_handle_single_instance(
     gchar** arguments);
 
+// Sends |arguments| (NULL-terminated, without the binary name), the working directory & the startup notification environment variables
+// to the primary instance of |application|, over its single instance socket. Launches arriving together are delivered to Dart in one
+// batch. Returns TRUE if the primary instance received them, FALSE if none is running.
+FLUTTER_PLUGIN_EXPORT gboolean window_plus_plugin_send_single_instance_arguments(
+    const gchar* application, gchar** arguments);
+
+// Must be called first thing in |main|. If a primary instance of |application| is already running, hands the arguments over to it &
+// exits the process right away i.e. before any GtkWindow, FlView or Flutter engine is created. Returns otherwise.
+FLUTTER_PLUGIN_EXPORT void window_plus_plugin_ensure_single_instance(
+    const gchar* application, gint argc, gchar** argv);
+
+// Copies the window state snapshot of the window with |window_id| (i.e. the handle returned by |WindowPlus.ensureInitialized|) to
+// |result|, consistently i.e. retrying while the plugin is writing it. Safe to call from any thread. Returns FALSE if no such window is
+// registered.
+FLUTTER_PLUGIN_EXPORT gboolean window_plus_plugin_copy_state_snapshot_for_window(
+    gint64 window_id, WindowPlusStateSnapshot* result);
+
+// Returns |g_get_monotonic_time| i.e. the clock used for the timestamps of all window events. Read from Dart through FFI.
+FLUTTER_PLUGIN_EXPORT gint64 window_plus_plugin_get_monotonic_time();
+
 G_END_DECLS
 
 #endif  // FLUTTER_PLUGIN_WINDOW_PLUS_PLUGIN_H_
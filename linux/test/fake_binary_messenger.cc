@@ -0,0 +1,136 @@
+#include "test/fake_binary_messenger.h"
+
+G_DECLARE_FINAL_TYPE(FakeBinaryMessengerResponseHandle, fake_binary_messenger_response_handle, FAKE, BINARY_MESSENGER_RESPONSE_HANDLE,
+                     FlBinaryMessengerResponseHandle)
+
+struct _FakeBinaryMessengerResponseHandle {
+  FlBinaryMessengerResponseHandle parent_instance;
+  // Completed with the response, NULL if the sender is not interested in it.
+  GTask* task;
+};
+
+G_DEFINE_TYPE(FakeBinaryMessengerResponseHandle, fake_binary_messenger_response_handle, fl_binary_messenger_response_handle_get_type())
+
+static void complete_response(FakeBinaryMessengerResponseHandle* self, GBytes* response) {
+  if (self->task == nullptr) {
+    return;
+  }
+  g_task_return_pointer(self->task, response != nullptr ? g_bytes_ref(response) : g_bytes_new(nullptr, 0), reinterpret_cast<GDestroyNotify>(g_bytes_unref));
+  g_clear_object(&self->task);
+}
+
+static void fake_binary_messenger_response_handle_dispose(GObject* object) {
+  FakeBinaryMessengerResponseHandle* self = FAKE_BINARY_MESSENGER_RESPONSE_HANDLE(object);
+  // Never responded to i.e. same as the engine's empty response for unhandled messages.
+  complete_response(self, nullptr);
+  G_OBJECT_CLASS(fake_binary_messenger_response_handle_parent_class)->dispose(object);
+}
+
+static void fake_binary_messenger_response_handle_class_init(FakeBinaryMessengerResponseHandleClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = fake_binary_messenger_response_handle_dispose;
+}
+
+static void fake_binary_messenger_response_handle_init(FakeBinaryMessengerResponseHandle* self) { self->task = nullptr; }
+
+typedef struct {
+  FlBinaryMessengerMessageHandler handler;
+  gpointer user_data;
+  GDestroyNotify destroy_notify;
+} MessageHandler;
+
+static void message_handler_free(gpointer data) {
+  MessageHandler* handler = static_cast<MessageHandler*>(data);
+  if (handler->destroy_notify != nullptr) {
+    handler->destroy_notify(handler->user_data);
+  }
+  g_free(handler);
+}
+
+struct _FakeBinaryMessenger {
+  GObject parent_instance;
+  FakeBinaryMessenger* peer;
+  // Channel name -> |MessageHandler|.
+  GHashTable* handlers;
+};
+
+static void fake_binary_messenger_iface_init(FlBinaryMessengerInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(FakeBinaryMessenger, fake_binary_messenger, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(fl_binary_messenger_get_type(), fake_binary_messenger_iface_init))
+
+static void set_message_handler_on_channel(FlBinaryMessenger* messenger, const gchar* channel, FlBinaryMessengerMessageHandler handler,
+                                           gpointer user_data, GDestroyNotify destroy_notify) {
+  FakeBinaryMessenger* self = FAKE_BINARY_MESSENGER(messenger);
+  if (handler == nullptr) {
+    g_hash_table_remove(self->handlers, channel);
+    return;
+  }
+  MessageHandler* value = g_new0(MessageHandler, 1);
+  value->handler = handler;
+  value->user_data = user_data;
+  value->destroy_notify = destroy_notify;
+  g_hash_table_replace(self->handlers, g_strdup(channel), value);
+}
+
+static gboolean send_response(FlBinaryMessenger* messenger, FlBinaryMessengerResponseHandle* response_handle, GBytes* response, GError** error) {
+  complete_response(FAKE_BINARY_MESSENGER_RESPONSE_HANDLE(response_handle), response);
+  return TRUE;
+}
+
+static void send_on_channel(FlBinaryMessenger* messenger, const gchar* channel, GBytes* message, GCancellable* cancellable,
+                            GAsyncReadyCallback callback, gpointer user_data) {
+  FakeBinaryMessenger* self = FAKE_BINARY_MESSENGER(messenger);
+  FakeBinaryMessengerResponseHandle* handle =
+      FAKE_BINARY_MESSENGER_RESPONSE_HANDLE(g_object_new(fake_binary_messenger_response_handle_get_type(), nullptr));
+  if (callback != nullptr) {
+    handle->task = g_task_new(self, cancellable, callback, user_data);
+  }
+  MessageHandler* handler = self->peer != nullptr ? static_cast<MessageHandler*>(g_hash_table_lookup(self->peer->handlers, channel)) : nullptr;
+  if (handler != nullptr) {
+    handler->handler(FL_BINARY_MESSENGER(self->peer), channel, message, FL_BINARY_MESSENGER_RESPONSE_HANDLE(handle), handler->user_data);
+  }
+  g_object_unref(handle);
+}
+
+static GBytes* send_on_channel_finish(FlBinaryMessenger* messenger, GAsyncResult* result, GError** error) {
+  return static_cast<GBytes*>(g_task_propagate_pointer(G_TASK(result), error));
+}
+
+static void resize_channel(FlBinaryMessenger* messenger, const gchar* channel, int64_t new_size) {}
+
+static void set_warns_on_channel_overflow(FlBinaryMessenger* messenger, const gchar* channel, bool warns) {}
+
+static void fake_binary_messenger_iface_init(FlBinaryMessengerInterface* iface) {
+  iface->set_message_handler_on_channel = set_message_handler_on_channel;
+  iface->send_response = send_response;
+  iface->send_on_channel = send_on_channel;
+  iface->send_on_channel_finish = send_on_channel_finish;
+  iface->resize_channel = resize_channel;
+  iface->set_warns_on_channel_overflow = set_warns_on_channel_overflow;
+}
+
+static void fake_binary_messenger_dispose(GObject* object) {
+  FakeBinaryMessenger* self = FAKE_BINARY_MESSENGER(object);
+  if (self->peer != nullptr) {
+    g_object_remove_weak_pointer(G_OBJECT(self->peer), reinterpret_cast<gpointer*>(&self->peer));
+    self->peer = nullptr;
+  }
+  g_clear_pointer(&self->handlers, g_hash_table_unref);
+  G_OBJECT_CLASS(fake_binary_messenger_parent_class)->dispose(object);
+}
+
+static void fake_binary_messenger_class_init(FakeBinaryMessengerClass* klass) { G_OBJECT_CLASS(klass)->dispose = fake_binary_messenger_dispose; }
+
+static void fake_binary_messenger_init(FakeBinaryMessenger* self) {
+  self->peer = nullptr;
+  self->handlers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, message_handler_free);
+}
+
+FakeBinaryMessenger* fake_binary_messenger_new() { return FAKE_BINARY_MESSENGER(g_object_new(fake_binary_messenger_get_type(), nullptr)); }
+
+void fake_binary_messenger_connect(FakeBinaryMessenger* messenger, FakeBinaryMessenger* peer) {
+  messenger->peer = peer;
+  g_object_add_weak_pointer(G_OBJECT(peer), reinterpret_cast<gpointer*>(&messenger->peer));
+  peer->peer = messenger;
+  g_object_add_weak_pointer(G_OBJECT(messenger), reinterpret_cast<gpointer*>(&peer->peer));
+}
@@ -0,0 +1,19 @@
+#ifndef FLUTTER_PLUGIN_WINDOW_PLUS_FAKE_BINARY_MESSENGER_H_
+#define FLUTTER_PLUGIN_WINDOW_PLUS_FAKE_BINARY_MESSENGER_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_BEGIN_DECLS
+
+// In-process FlBinaryMessenger standing in for the Flutter engine in tests. Messages sent on one messenger are delivered to the
+// handlers registered on its |peer| & the responses are routed back i.e. channels created on the peer behave like the Dart side.
+G_DECLARE_FINAL_TYPE(FakeBinaryMessenger, fake_binary_messenger, FAKE, BINARY_MESSENGER, GObject)
+
+FakeBinaryMessenger* fake_binary_messenger_new();
+
+// Connects |messenger| & |peer| to each other. Neither holds a reference to the other.
+void fake_binary_messenger_connect(FakeBinaryMessenger* messenger, FakeBinaryMessenger* peer);
+
+G_END_DECLS
+
+#endif  // FLUTTER_PLUGIN_WINDOW_PLUS_FAKE_BINARY_MESSENGER_H_
@@ -0,0 +1,339 @@
+#include "test/plugin_harness.h"
+
+#include <glib/gstdio.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+static constexpr auto kMethodChannelName = "com.alexmercerind/window_plus";
+static constexpr auto kEventChannelName = "com.alexmercerind/window_plus/events";
+static constexpr auto kLifecycleChannelName = "flutter/lifecycle";
+
+// Keep in sync with |kEventRecord*| in lib/src/common.dart.
+static constexpr gsize kEventRecordSize = 64;
+static constexpr gsize kEventRecordTypeOffset = 0;
+static constexpr gsize kEventRecordStateOffset = 4;
+static constexpr gsize kEventRecordSequenceOffset = 8;
+static constexpr gsize kEventRecordTimestampOffset = 16;
+static constexpr gsize kEventRecordXOffset = 24;
+static constexpr gsize kEventRecordYOffset = 28;
+static constexpr gsize kEventRecordWidthOffset = 32;
+static constexpr gsize kEventRecordHeightOffset = 36;
+static constexpr gsize kEventRecordChangedOffset = 40;
+static constexpr gsize kEventRecordFrameLeftOffset = 48;
+static constexpr gsize kEventRecordFrameTopOffset = 52;
+static constexpr gsize kEventRecordFrameRightOffset = 56;
+static constexpr gsize kEventRecordFrameBottomOffset = 60;
+
+static gint32 read_int32(const uint8_t* data, gsize offset) {
+  gint32 value;
+  memcpy(&value, data + offset, sizeof(value));
+  return GINT32_FROM_LE(value);
+}
+
+static gint64 read_int64(const uint8_t* data, gsize offset) {
+  gint64 value;
+  memcpy(&value, data + offset, sizeof(value));
+  return GINT64_FROM_LE(value);
+}
+
+PluginHarness::PluginHarness(const gchar* application) : application_(g_strdup(application)) {
+  messenger_ = fake_binary_messenger_new();
+  dart_messenger_ = fake_binary_messenger_new();
+  fake_binary_messenger_connect(messenger_, dart_messenger_);
+  method_calls_ = g_ptr_array_new_with_free_func(g_object_unref);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  channel_ = fl_method_channel_new(FL_BINARY_MESSENGER(dart_messenger_), kMethodChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel_, MethodCallCallback, this, nullptr);
+  g_autoptr(FlBinaryCodec) event_codec = fl_binary_codec_new();
+  event_channel_ = fl_basic_message_channel_new(FL_BINARY_MESSENGER(dart_messenger_), kEventChannelName, FL_MESSAGE_CODEC(event_codec));
+  fl_basic_message_channel_set_message_handler(event_channel_, EventCallback, this, nullptr);
+  g_autoptr(FlStringCodec) lifecycle_codec = fl_string_codec_new();
+  lifecycle_channel_ = fl_basic_message_channel_new(FL_BINARY_MESSENGER(dart_messenger_), kLifecycleChannelName, FL_MESSAGE_CODEC(lifecycle_codec));
+  fl_basic_message_channel_set_message_handler(lifecycle_channel_, LifecycleCallback, this, nullptr);
+
+  window_ = GTK_WIDGET(g_object_ref(gtk_window_new(GTK_WINDOW_TOPLEVEL)));
+  gtk_window_set_default_size(GTK_WINDOW(window_), 800, 600);
+  view_ = gtk_drawing_area_new();
+  gtk_widget_show(view_);
+  gtk_container_add(GTK_CONTAINER(window_), view_);
+
+  if (application_ != nullptr) {
+    window_plus_plugin_set_application(application_);
+  }
+  plugin_ = window_plus_plugin_new(FL_BINARY_MESSENGER(messenger_), view_);
+}
+
+PluginHarness::~PluginHarness() {
+  // The plugin is owned by its method channel, disposing releases it.
+  g_object_run_dispose(G_OBJECT(plugin_));
+  plugin_ = nullptr;
+  gtk_widget_destroy(window_);
+  g_clear_object(&window_);
+  window_plus_plugin_set_application(nullptr);
+  fl_method_channel_set_method_call_handler(channel_, nullptr, nullptr, nullptr);
+  fl_basic_message_channel_set_message_handler(event_channel_, nullptr, nullptr, nullptr);
+  fl_basic_message_channel_set_message_handler(lifecycle_channel_, nullptr, nullptr, nullptr);
+  g_clear_object(&channel_);
+  g_clear_object(&event_channel_);
+  g_clear_object(&lifecycle_channel_);
+  g_clear_object(&messenger_);
+  g_clear_object(&dart_messenger_);
+  g_ptr_array_unref(method_calls_);
+  if (application_ != nullptr) {
+    g_autofree gchar* directory = g_build_filename(g_get_home_dir(), ".config", application_, nullptr);
+    g_autoptr(GDir) dir = g_dir_open(directory, 0, nullptr);
+    const gchar* name = nullptr;
+    while (dir != nullptr && (name = g_dir_read_name(dir)) != nullptr) {
+      g_autofree gchar* path = g_build_filename(directory, name, nullptr);
+      g_remove(path);
+    }
+    g_rmdir(directory);
+    g_free(application_);
+  }
+}
+
+static void remove_recursively(const gchar* path) {
+  if (g_file_test(path, G_FILE_TEST_IS_DIR) && !g_file_test(path, G_FILE_TEST_IS_SYMLINK)) {
+    g_autoptr(GDir) dir = g_dir_open(path, 0, nullptr);
+    const gchar* name = nullptr;
+    while (dir != nullptr && (name = g_dir_read_name(dir)) != nullptr) {
+      g_autofree gchar* child = g_build_filename(path, name, nullptr);
+      remove_recursively(child);
+    }
+    g_rmdir(path);
+  } else {
+    g_remove(path);
+  }
+}
+
+gchar* use_temporary_home() {
+  gchar* directory = g_dir_make_tmp("window_plus_test.XXXXXX", nullptr);
+  if (directory == nullptr) {
+    return nullptr;
+  }
+  g_autofree gchar* config = g_build_filename(directory, ".config", nullptr);
+  g_setenv("HOME", directory, TRUE);
+  g_setenv("XDG_CONFIG_HOME", config, TRUE);
+  return directory;
+}
+
+void remove_temporary_home(const gchar* directory) {
+  if (directory != nullptr) {
+    remove_recursively(directory);
+  }
+}
+
+typedef struct {
+  gboolean done;
+  FlMethodResponse* response;
+} InvokeMethodContext;
+
+static void invoke_method_cb(GObject* object, GAsyncResult* result, gpointer user_data) {
+  InvokeMethodContext* context = static_cast<InvokeMethodContext*>(user_data);
+  context->response = fl_method_channel_invoke_method_finish(FL_METHOD_CHANNEL(object), result, nullptr);
+  context->done = TRUE;
+}
+
+FlValue* PluginHarness::InvokeMethod(const gchar* method, FlValue* arguments) {
+  InvokeMethodContext context = {FALSE, nullptr};
+  fl_method_channel_invoke_method(channel_, method, arguments, nullptr, invoke_method_cb, &context);
+  while (!context.done) {
+    g_main_context_iteration(nullptr, TRUE);
+  }
+  if (context.response == nullptr) {
+    return nullptr;
+  }
+  FlValue* result = fl_method_response_get_result(context.response, nullptr);
+  if (result != nullptr) {
+    fl_value_ref(result);
+  }
+  g_object_unref(context.response);
+  return result;
+}
+
+gint64 PluginHarness::EnsureInitialized(gboolean enable_event_streams) {
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "enableEventStreams", fl_value_new_bool(enable_event_streams));
+  fl_value_set_string_take(arguments, "enableCustomFrame", fl_value_new_bool(FALSE));
+  fl_value_set_string_take(arguments, "pauseWhenOccluded", fl_value_new_bool(FALSE));
+  g_autoptr(FlValue) result = InvokeMethod("ensureInitialized", arguments);
+  return result != nullptr && fl_value_get_type(result) == FL_VALUE_TYPE_INT ? fl_value_get_int(result) : 0;
+}
+
+gint64 PluginHarness::EnsureInitializedWith(std::initializer_list<std::pair<const gchar*, FlValue*>> options) {
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "enableEventStreams", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(arguments, "enableCustomFrame", fl_value_new_bool(FALSE));
+  fl_value_set_string_take(arguments, "pauseWhenOccluded", fl_value_new_bool(FALSE));
+  for (const auto& option : options) {
+    fl_value_set_string_take(arguments, option.first, option.second);
+  }
+  g_autoptr(FlValue) result = InvokeMethod("ensureInitialized", arguments);
+  return result != nullptr && fl_value_get_type(result) == FL_VALUE_TYPE_INT ? fl_value_get_int(result) : 0;
+}
+
+void PluginHarness::SubscribeEvents(gint type) {
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "type", fl_value_new_int(type));
+  g_autoptr(FlValue) result = InvokeMethod("subscribeEvents", arguments);
+}
+
+static gboolean timeout_elapsed_cb(gpointer user_data) {
+  *static_cast<gboolean*>(user_data) = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+FlValue* PluginHarness::WaitForMethodCall(const gchar* method, gint64 timeout) {
+  gboolean elapsed = FALSE;
+  guint source_id = g_timeout_add(timeout / 1000, timeout_elapsed_cb, &elapsed);
+  FlValue* result = nullptr;
+  while (result == nullptr) {
+    for (guint i = 0; i < method_calls_->len; i++) {
+      FlMethodCall* method_call = FL_METHOD_CALL(g_ptr_array_index(method_calls_, i));
+      if (strcmp(fl_method_call_get_name(method_call), method) == 0) {
+        result = fl_value_ref(fl_method_call_get_args(method_call));
+        g_ptr_array_remove_index(method_calls_, i);
+        break;
+      }
+    }
+    if (result != nullptr || elapsed) {
+      break;
+    }
+    g_main_context_iteration(nullptr, TRUE);
+  }
+  if (!elapsed) {
+    g_source_remove(source_id);
+  }
+  return result;
+}
+
+void PluginHarness::Iterate(gint64 duration) {
+  gboolean elapsed = FALSE;
+  g_timeout_add(duration / 1000, timeout_elapsed_cb, &elapsed);
+  while (!elapsed) {
+    g_main_context_iteration(nullptr, TRUE);
+  }
+}
+
+void PluginHarness::DispatchConfigureEvent(gint x, gint y, gint width, gint height) {
+  GdkEvent* event = gdk_event_new(GDK_CONFIGURE);
+  event->configure.window = GDK_WINDOW(g_object_ref(gtk_widget_get_window(window_)));
+  event->configure.send_event = TRUE;
+  event->configure.x = x;
+  event->configure.y = y;
+  event->configure.width = width;
+  event->configure.height = height;
+  gtk_main_do_event(event);
+  gdk_event_free(event);
+}
+
+void PluginHarness::DispatchWindowStateEvent(GdkWindowState changed_mask, GdkWindowState new_window_state) {
+  GdkEvent* event = gdk_event_new(GDK_WINDOW_STATE);
+  event->window_state.window = GDK_WINDOW(g_object_ref(gtk_widget_get_window(window_)));
+  event->window_state.send_event = TRUE;
+  event->window_state.changed_mask = changed_mask;
+  event->window_state.new_window_state = new_window_state;
+  gtk_main_do_event(event);
+  gdk_event_free(event);
+}
+
+void PluginHarness::DispatchVisibilityEvent(GdkVisibilityState state) {
+  GdkEvent* event = gdk_event_new(GDK_VISIBILITY_NOTIFY);
+  event->visibility.window = GDK_WINDOW(g_object_ref(gtk_widget_get_window(window_)));
+  event->visibility.send_event = TRUE;
+  event->visibility.state = state;
+  gtk_main_do_event(event);
+  gdk_event_free(event);
+}
+
+void PluginHarness::MethodCallCallback(FlMethodChannel* channel, FlMethodCall* method_call, gpointer user_data) {
+  PluginHarness* self = static_cast<PluginHarness*>(user_data);
+  g_ptr_array_add(self->method_calls_, g_object_ref(method_call));
+  fl_method_call_respond_success(method_call, nullptr, nullptr);
+}
+
+void PluginHarness::EventCallback(FlBasicMessageChannel* channel, FlValue* message, FlBasicMessageChannelResponseHandle* response_handle,
+                                  gpointer user_data) {
+  PluginHarness* self = static_cast<PluginHarness*>(user_data);
+  self->event_count_++;
+  const uint8_t* data = fl_value_get_type(message) == FL_VALUE_TYPE_UINT8_LIST ? fl_value_get_uint8_list(message) : nullptr;
+  gsize length = data != nullptr ? fl_value_get_length(message) : 0;
+  gint32 type = length == kEventRecordSize ? read_int32(data, kEventRecordTypeOffset) : -1;
+  if (type < 0 || type >= kEventTypeCount) {
+    self->invalid_event_count_++;
+  } else {
+    EventRecord& record = self->last_events_[type];
+    record.type = type;
+    record.state = static_cast<guint32>(read_int32(data, kEventRecordStateOffset));
+    record.sequence = read_int64(data, kEventRecordSequenceOffset);
+    record.timestamp = read_int64(data, kEventRecordTimestampOffset);
+    record.x = read_int32(data, kEventRecordXOffset);
+    record.y = read_int32(data, kEventRecordYOffset);
+    record.width = read_int32(data, kEventRecordWidthOffset);
+    record.height = read_int32(data, kEventRecordHeightOffset);
+    record.changed = static_cast<guint32>(read_int32(data, kEventRecordChangedOffset));
+    record.frame_left = read_int32(data, kEventRecordFrameLeftOffset);
+    record.frame_top = read_int32(data, kEventRecordFrameTopOffset);
+    record.frame_right = read_int32(data, kEventRecordFrameRightOffset);
+    record.frame_bottom = read_int32(data, kEventRecordFrameBottomOffset);
+    self->event_counts_[type]++;
+  }
+  g_autoptr(FlValue) response = fl_value_new_uint8_list(nullptr, 0);
+  fl_basic_message_channel_respond(channel, response_handle, response, nullptr);
+}
+
+void PluginHarness::LifecycleCallback(FlBasicMessageChannel* channel, FlValue* message, FlBasicMessageChannelResponseHandle* response_handle,
+                                      gpointer user_data) {
+  PluginHarness* self = static_cast<PluginHarness*>(user_data);
+  self->lifecycle_states_.emplace_back(fl_value_get_type(message) == FL_VALUE_TYPE_STRING ? fl_value_get_string(message) : "");
+  g_autoptr(FlValue) response = fl_value_new_string("");
+  fl_basic_message_channel_respond(channel, response_handle, response, nullptr);
+}
+
+static FlValue* new_map(std::initializer_list<std::pair<const gchar*, FlValue*>> entries) {
+  FlValue* result = fl_value_new_map();
+  for (const auto& entry : entries) {
+    fl_value_set_string_take(result, entry.first, entry.second);
+  }
+  return result;
+}
+
+std::vector<RepeatableMethodCall> get_repeatable_method_calls() {
+  static constexpr int32_t kCaptionRegion[] = {1, 0, 0, 0, 800, 32};
+  // Configure events.
+  static constexpr auto kEventType = 1;
+  return {
+      {"getState", nullptr},
+      {"getMinimumSize", nullptr},
+      {"setMinimumSize", new_map({{"width", fl_value_new_float(320.0)}, {"height", fl_value_new_float(240.0)}})},
+      {"getMinimized", nullptr},
+      {"getMaximized", nullptr},
+      {"getIsFullscreen", nullptr},
+      {"getSize", nullptr},
+      {"getPosition", nullptr},
+      {"getMonitors", nullptr},
+      {"move", new_map({{"x", fl_value_new_int(100)}, {"y", fl_value_new_int(100)}})},
+      {"resize", new_map({{"width", fl_value_new_int(800)}, {"height", fl_value_new_int(600)}})},
+      {"applyWindowTransaction",
+       new_map({{"x", fl_value_new_int(100)}, {"y", fl_value_new_int(100)}, {"width", fl_value_new_int(800)}, {"height", fl_value_new_int(600)}})},
+      {"getSavedWindowState", nullptr},
+      {"getStartupProfile", nullptr},
+      {"subscribeEvents", new_map({{"type", fl_value_new_int(kEventType)}})},
+      {"unsubscribeEvents", new_map({{"type", fl_value_new_int(kEventType)}})},
+      {"setCaptionRegions", new_map({{"regions", fl_value_new_int32_list(kCaptionRegion, G_N_ELEMENTS(kCaptionRegion))}, {"removed", fl_value_new_null()}})},
+      {"notifyFrameBuilt", new_map({{"width", fl_value_new_int(800)}, {"height", fl_value_new_int(600)}})},
+      {"notifyFrameRasterized", new_map({{"width", fl_value_new_int(800)}, {"height", fl_value_new_int(600)}, {"rasterFinish", fl_value_new_int(0)}})},
+      {"getDroppedEventCount", nullptr},
+      {"getMismatchedResizeFrameCount", nullptr},
+  };
+}
+
+void free_repeatable_method_calls(std::vector<RepeatableMethodCall>& method_calls) {
+  for (auto& method_call : method_calls) {
+    g_clear_pointer(&method_call.arguments, fl_value_unref);
+  }
+  method_calls.clear();
+}
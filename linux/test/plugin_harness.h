@@ -0,0 +1,136 @@
+#ifndef FLUTTER_PLUGIN_WINDOW_PLUS_PLUGIN_HARNESS_H_
+#define FLUTTER_PLUGIN_WINDOW_PLUS_PLUGIN_HARNESS_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <gtk/gtk.h>
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test/fake_binary_messenger.h"
+#include "window_plus_plugin_private.h"
+
+// A |WindowPlusEventRecord| decoded field by field at the same (little-endian) offsets as the Dart side.
+struct EventRecord {
+  gint32 type;
+  guint32 state;
+  gint64 sequence;
+  gint64 timestamp;
+  gint32 x;
+  gint32 y;
+  gint32 width;
+  gint32 height;
+  guint32 changed;
+  gint32 frame_left;
+  gint32 frame_top;
+  gint32 frame_right;
+  gint32 frame_bottom;
+};
+
+// Registers the plugin for a new GtkWindow (with a stand-in for the FlView) on a fake messenger & talks to it the way the Dart side
+// does. Requires |gtk_init_check| to have succeeded i.e. a display.
+class PluginHarness {
+ public:
+  // |application| is set with |window_plus_plugin_set_application| first, which makes the plugin restore the saved window state & listen
+  // for secondary instances (if it is the first one created). Its files in ~/.config are removed when the harness is destroyed.
+  explicit PluginHarness(const gchar* application = nullptr);
+  ~PluginHarness();
+
+  PluginHarness(const PluginHarness&) = delete;
+  PluginHarness& operator=(const PluginHarness&) = delete;
+
+  // Invokes |ensureInitialized| like |WindowPlus.ensureInitialized| with the default options. Returns the window handle.
+  gint64 EnsureInitialized(gboolean enable_event_streams = TRUE);
+
+  // Same as |EnsureInitialized|, with |options| added to (or replacing) the default ones. Takes ownership of the values.
+  gint64 EnsureInitializedWith(std::initializer_list<std::pair<const gchar*, FlValue*>> options);
+
+  // Invokes |subscribeEvents| for the events of |type|.
+  void SubscribeEvents(gint type);
+
+  // Invokes |method| like |MethodChannel.invokeMethod| & waits for the response. Returns the result, NULL for errors & unimplemented methods.
+  FlValue* InvokeMethod(const gchar* method, FlValue* arguments = nullptr);
+
+  // Runs the main loop until the plugin invokes |method| on the Dart side or |timeout| (in microseconds) elapses. Returns the arguments of
+  // the (oldest) call, NULL on timeout.
+  FlValue* WaitForMethodCall(const gchar* method, gint64 timeout);
+
+  // Runs the main loop for |duration| (in microseconds).
+  void Iterate(gint64 duration);
+
+  // Dispatches a synthetic configure-event to the window like GTK does for the ones from the display server, without iterating the main
+  // loop i.e. any number of them arrive "at once".
+  void DispatchConfigureEvent(gint x, gint y, gint width, gint height);
+
+  // Same for a synthetic window-state-event.
+  void DispatchWindowStateEvent(GdkWindowState changed_mask, GdkWindowState new_window_state);
+
+  // Same for a synthetic visibility-notify-event.
+  void DispatchVisibilityEvent(GdkVisibilityState state);
+
+  GtkWindow* window() const { return GTK_WINDOW(window_); }
+  // Stand-in for the FlView.
+  GtkWidget* view() const { return view_; }
+  WindowPlusPlugin* plugin() const { return plugin_; }
+  // Number of event records received on the event channel.
+  guint event_count() const { return event_count_; }
+  // Number of event records of |type| received on the event channel & the latest one (zeroed if none).
+  guint event_count(gint type) const { return type >= 0 && type < kEventTypeCount ? event_counts_[type] : 0; }
+  const EventRecord& last_event(gint type) const { return last_events_[type >= 0 && type < kEventTypeCount ? type : 0]; }
+  // Number of messages on the event channel that are not a valid event record (wrong length or type).
+  guint invalid_event_count() const { return invalid_event_count_; }
+  // Messages received on the flutter/lifecycle channel i.e. the AppLifecycleState(s) sent to the engine.
+  const std::vector<std::string>& lifecycle_states() const { return lifecycle_states_; }
+
+ private:
+  static void MethodCallCallback(FlMethodChannel* channel, FlMethodCall* method_call, gpointer user_data);
+  static void EventCallback(FlBasicMessageChannel* channel, FlValue* message, FlBasicMessageChannelResponseHandle* response_handle,
+                            gpointer user_data);
+  static void LifecycleCallback(FlBasicMessageChannel* channel, FlValue* message, FlBasicMessageChannelResponseHandle* response_handle,
+                                gpointer user_data);
+
+  gchar* application_ = nullptr;
+  FakeBinaryMessenger* messenger_ = nullptr;
+  // The Dart side.
+  FakeBinaryMessenger* dart_messenger_ = nullptr;
+  FlMethodChannel* channel_ = nullptr;
+  FlBasicMessageChannel* event_channel_ = nullptr;
+  FlBasicMessageChannel* lifecycle_channel_ = nullptr;
+  // Referenced, the plugin may destroy it.
+  GtkWidget* window_ = nullptr;
+  GtkWidget* view_ = nullptr;
+  WindowPlusPlugin* plugin_ = nullptr;
+  // |FlMethodCall|s received from the plugin, not waited for yet.
+  GPtrArray* method_calls_ = nullptr;
+  // Fixed size (not one entry per record), the benchmark & the soak test receive any number of them.
+  static constexpr gint kEventTypeCount = 8;
+  guint event_count_ = 0;
+  guint event_counts_[kEventTypeCount] = {};
+  EventRecord last_events_[kEventTypeCount] = {};
+  guint invalid_event_count_ = 0;
+  std::vector<std::string> lifecycle_states_;
+};
+
+// Points $HOME & $XDG_CONFIG_HOME at a new temporary directory, so that the harnesses (e.g. the saved window state of an |application|) do
+// not write into the user's profile. Must be called before anything reads them i.e. before |gtk_init_check|, GLib caches both. Returns the
+// directory, remove it with |remove_temporary_home|.
+gchar* use_temporary_home();
+
+void remove_temporary_home(const gchar* directory);
+
+// A method call that is safe to repeat any number of times & in any order, after |PluginHarness::EnsureInitialized|.
+struct RepeatableMethodCall {
+  const gchar* method;
+  // NULL for none.
+  FlValue* arguments;
+};
+
+// Returns every method of the plugin, except the ones closing the window or changing its visibility & state (which the window manager
+// answers asynchronously). Release with |free_repeatable_method_calls|.
+std::vector<RepeatableMethodCall> get_repeatable_method_calls();
+
+void free_repeatable_method_calls(std::vector<RepeatableMethodCall>& method_calls);
+
+#endif  // FLUTTER_PLUGIN_WINDOW_PLUS_PLUGIN_HARNESS_H_
@@ -0,0 +1,138 @@
+// Measures the secondary instance launches handed over to a primary instance i.e. |window_plus_plugin_ensure_single_instance| called
+// first thing in |main|, in a process re-executed from this binary. Reports the wall time from spawn to exit & the peak RSS of the
+// secondary instances, next to the same for a process exiting right away (the cost of a bare process launch).
+//
+// $ xvfb-run build/linux/x64/release/plugins/window_plus/window_plus_single_instance_benchmark [launches]
+
+#include <gtk/gtk.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "include/window_plus/window_plus_plugin.h"
+#include "test/plugin_harness.h"
+
+static constexpr auto kSecondaryArgument = "--secondary";
+static constexpr auto kIdleArgument = "--idle";
+static constexpr auto kDefaultLaunchCount = 200;
+static constexpr auto kDeliveryTimeout = 10 * G_USEC_PER_SEC;
+
+typedef struct {
+  gboolean exited;
+  gint status;
+} ChildContext;
+
+static void child_exited_cb(GPid pid, gint status, gpointer user_data) {
+  ChildContext* context = static_cast<ChildContext*>(user_data);
+  context->exited = TRUE;
+  context->status = status;
+  g_spawn_close_pid(pid);
+}
+
+// Spawns this binary with |arguments| & waits for it to exit. Returns the wall time in microseconds, -1 if it failed.
+static gint64 run_child(const gchar* const* arguments) {
+  g_autoptr(GError) error = nullptr;
+  GPid pid = 0;
+  gint64 start = g_get_monotonic_time();
+  if (!g_spawn_async(nullptr, const_cast<gchar**>(arguments), nullptr, G_SPAWN_DO_NOT_REAP_CHILD, nullptr, nullptr, &pid, &error)) {
+    g_printerr("%s\n", error->message);
+    return -1;
+  }
+  ChildContext context = {FALSE, 0};
+  g_child_watch_add(pid, child_exited_cb, &context);
+  while (!context.exited) {
+    g_main_context_iteration(nullptr, TRUE);
+  }
+  gint64 elapsed = g_get_monotonic_time() - start;
+  return WIFEXITED(context.status) && WEXITSTATUS(context.status) == EXIT_SUCCESS ? elapsed : -1;
+}
+
+// Peak RSS (in KiB) of all the children waited for so far.
+static glong get_children_peak_rss() {
+  struct rusage usage;
+  getrusage(RUSAGE_CHILDREN, &usage);
+  return usage.ru_maxrss;
+}
+
+static void print_wall_times(const gchar* label, std::vector<gint64>& wall_times) {
+  std::sort(wall_times.begin(), wall_times.end());
+  gdouble total = 0.0;
+  for (gint64 wall_time : wall_times) {
+    total += wall_time;
+  }
+  size_t count = wall_times.size();
+  g_print("%-10s wall time (us): mean %.1f, p50 %" G_GINT64_FORMAT ", p99 %" G_GINT64_FORMAT ", max %" G_GINT64_FORMAT "\n", label, total / count,
+          wall_times[(count - 1) / 2], wall_times[std::min(count - 1, count * 99 / 100)], wall_times.back());
+}
+
+int main(int argc, char** argv) {
+  // Same as the runner's |main|.
+  if (argc >= 3 && strcmp(argv[1], kSecondaryArgument) == 0) {
+    window_plus_plugin_ensure_single_instance(argv[2], argc - 2, argv + 2);
+    return EXIT_FAILURE;
+  }
+  if (argc >= 2 && strcmp(argv[1], kIdleArgument) == 0) {
+    return EXIT_SUCCESS;
+  }
+  gint launch_count = argc >= 2 ? atoi(argv[1]) : kDefaultLaunchCount;
+  if (launch_count <= 0) {
+    g_printerr("Usage: %s [launches]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!gtk_init_check(&argc, &argv)) {
+    g_printerr("No display available.\n");
+    return EXIT_FAILURE;
+  }
+  g_autofree gchar* executable = g_file_read_link("/proc/self/exe", nullptr);
+  g_autofree gchar* application = g_strdup_printf("window_plus_benchmark.%d", getpid());
+
+  std::vector<gint64> idle_wall_times;
+  const gchar* idle_arguments[] = {executable, kIdleArgument, nullptr};
+  for (gint i = 0; i < launch_count; i++) {
+    gint64 wall_time = run_child(idle_arguments);
+    if (wall_time < 0) {
+      g_printerr("Idle launch failed.\n");
+      return EXIT_FAILURE;
+    }
+    idle_wall_times.push_back(wall_time);
+  }
+  glong idle_peak_rss = get_children_peak_rss();
+
+  PluginHarness harness(application);
+  std::vector<gint64> wall_times;
+  for (gint i = 0; i < launch_count; i++) {
+    g_autofree gchar* file = g_strdup_printf("file-%d.txt", i);
+    const gchar* arguments[] = {executable, kSecondaryArgument, application, file, nullptr};
+    gint64 wall_time = run_child(arguments);
+    if (wall_time < 0) {
+      g_printerr("Secondary launch %d was not handed over.\n", i);
+      return EXIT_FAILURE;
+    }
+    wall_times.push_back(wall_time);
+  }
+  glong peak_rss = get_children_peak_rss();
+
+  guint delivered = 0, batches = 0;
+  while (delivered < static_cast<guint>(launch_count)) {
+    g_autoptr(FlValue) data = harness.WaitForMethodCall("singleInstanceDataReceived", kDeliveryTimeout);
+    if (data == nullptr) {
+      break;
+    }
+    delivered += fl_value_get_length(fl_value_lookup_string(data, "launches"));
+    batches++;
+  }
+
+  g_print("launches: %d\n", launch_count);
+  print_wall_times("idle", idle_wall_times);
+  print_wall_times("secondary", wall_times);
+  // |ru_maxrss| of the children is the maximum so far, the secondary instances only raise it if they peak higher.
+  g_print("peak RSS (KiB): idle %ld, secondary %ld\n", idle_peak_rss, peak_rss);
+  g_print("delivered: %u launches in %u batches\n", delivered, batches);
+  return delivered == static_cast<guint>(launch_count) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
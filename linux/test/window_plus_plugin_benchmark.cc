@@ -0,0 +1,171 @@
+// Measures every repeatable method call through the fake messenger (encoding, dispatch, handler & response) & floods of synthetic
+// configure-event(s) & window-state-event(s) dispatched to the window with all the event streams subscribed. Reports ns/op, exact p50 &
+// p99 (from the sorted samples) & heap allocations/op, counted on the calling thread by wrapping glibc's malloc, calloc, realloc & aligned
+// allocators (memalign, posix_memalign & aligned_alloc). Allocations are not counted (reported as -) with other C libraries.
+//
+// $ xvfb-run build/linux/x64/release/plugins/window_plus/window_plus_benchmark [iterations]
+
+#include <errno.h>
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <vector>
+
+#include "test/plugin_harness.h"
+
+static constexpr auto kDefaultIterationCount = 10000;
+static constexpr auto kWarmUpIterationCount = 100;
+// Keep in sync with |kWindowStateEventType| & |kConfigureEventType| in the plugin.
+static constexpr auto kWindowStateEventType = 0;
+static constexpr auto kConfigureEventType = 1;
+
+static thread_local uint64_t allocation_count = 0;
+
+#ifdef __GLIBC__
+static constexpr bool kAllocationsCounted = true;
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+  allocation_count++;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  allocation_count++;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+  allocation_count++;
+  return __libc_realloc(pointer, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+  allocation_count++;
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  allocation_count++;
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  allocation_count++;
+  void* result = __libc_memalign(alignment, size);
+  if (result == nullptr) {
+    return ENOMEM;
+  }
+  *pointer = result;
+  return 0;
+}
+}
+#else
+static constexpr bool kAllocationsCounted = false;
+#endif
+
+static uint64_t get_monotonic_time_ns() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+// Runs |operation| |iteration_count| times (after a warm-up) & prints a row of the report.
+static void measure(const gchar* name, gint iteration_count, const std::function<void(gint)>& operation) {
+  for (gint i = 0; i < kWarmUpIterationCount; i++) {
+    operation(i);
+  }
+  std::vector<uint64_t> samples;
+  samples.reserve(iteration_count);
+  uint64_t allocations = 0;
+  for (gint i = 0; i < iteration_count; i++) {
+    uint64_t start_allocations = allocation_count;
+    uint64_t start = get_monotonic_time_ns();
+    operation(i);
+    samples.push_back(get_monotonic_time_ns() - start);
+    allocations += allocation_count - start_allocations;
+  }
+  uint64_t total = 0;
+  for (uint64_t sample : samples) {
+    total += sample;
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t count = samples.size();
+  // Nearest-rank percentiles.
+  uint64_t p50 = samples[(count * 50 + 99) / 100 - 1];
+  uint64_t p99 = samples[(count * 99 + 99) / 100 - 1];
+  g_autofree gchar* allocations_per_op = kAllocationsCounted ? g_strdup_printf("%.2f", static_cast<gdouble>(allocations) / count) : g_strdup("-");
+  g_print("%-32s %10d %12.1f %12" G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT " %12s\n", name, iteration_count, static_cast<gdouble>(total) / count, p50, p99,
+          allocations_per_op);
+}
+
+// Dispatches |event| like GTK does for the events read from the display server. Takes ownership.
+static void dispatch_event(GdkEvent* event) {
+  gtk_main_do_event(event);
+  gdk_event_free(event);
+  while (g_main_context_iteration(nullptr, FALSE)) {
+  }
+}
+
+int main(int argc, char** argv) {
+  gint iteration_count = argc >= 2 ? atoi(argv[1]) : kDefaultIterationCount;
+  if (iteration_count <= 0) {
+    g_printerr("Usage: %s [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!gtk_init_check(&argc, &argv)) {
+    g_printerr("No display available.\n");
+    return EXIT_FAILURE;
+  }
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(harness.window()));
+
+  g_print("%-32s %10s %12s %12s %12s %12s\n", "name", "ops", "ns/op", "p50 ns", "p99 ns", "allocs/op");
+  std::vector<RepeatableMethodCall> method_calls = get_repeatable_method_calls();
+  for (const auto& method_call : method_calls) {
+    measure(method_call.method, iteration_count, [&](gint i) { g_autoptr(FlValue) result = harness.InvokeMethod(method_call.method, method_call.arguments); });
+  }
+  free_repeatable_method_calls(method_calls);
+
+  harness.SubscribeEvents(kWindowStateEventType);
+  harness.SubscribeEvents(kConfigureEventType);
+  guint event_count = harness.event_count();
+  measure("configure-event flood", iteration_count, [&](gint i) {
+    GdkEvent* event = gdk_event_new(GDK_CONFIGURE);
+    event->configure.window = GDK_WINDOW(g_object_ref(gdk_window));
+    event->configure.send_event = TRUE;
+    event->configure.x = 100 + i % 64;
+    event->configure.y = 100 + i % 32;
+    event->configure.width = gdk_window_get_width(gdk_window);
+    event->configure.height = gdk_window_get_height(gdk_window);
+    dispatch_event(event);
+  });
+  g_print("  %u events sent to Dart\n", harness.event_count() - event_count);
+  event_count = harness.event_count();
+  measure("window-state-event flood", iteration_count, [&](gint i) {
+    GdkEvent* event = gdk_event_new(GDK_WINDOW_STATE);
+    event->window_state.window = GDK_WINDOW(g_object_ref(gdk_window));
+    event->window_state.send_event = TRUE;
+    event->window_state.changed_mask = GDK_WINDOW_STATE_FOCUSED;
+    event->window_state.new_window_state = (i % 2) == 0 ? GDK_WINDOW_STATE_FOCUSED : static_cast<GdkWindowState>(0);
+    dispatch_event(event);
+  });
+  g_print("  %u events sent to Dart\n", harness.event_count() - event_count);
+  return EXIT_SUCCESS;
+}
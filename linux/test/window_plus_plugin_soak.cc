@@ -0,0 +1,63 @@
+// Invokes every repeatable method of the plugin many times, built with AddressSanitizer & LeakSanitizer. Reports the bytes still
+// allocated per call (after a warm-up) for each method & fails if any of them grows, LeakSanitizer reports the leaked allocations on exit.
+//
+// $ xvfb-run build/linux/x64/debug/plugins/window_plus/window_plus_soak [iterations]
+
+#include <gtk/gtk.h>
+#include <sanitizer/allocator_interface.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "test/plugin_harness.h"
+
+static constexpr auto kDefaultIterationCount = 1000000;
+static constexpr auto kWarmUpIterationCount = 1000;
+// Anything retained per call beyond rounding is a leak, since nothing the methods allocate is cached across calls.
+static constexpr auto kMaximumBytesPerCall = 1.0;
+
+// Allocations made by GTK, GDK & their dependencies for the lifetime of the process, which are never released.
+extern "C" const char* __lsan_default_suppressions() {
+  return "leak:libgtk-3.so\n"
+         "leak:libgdk-3.so\n"
+         "leak:libfontconfig.so\n"
+         "leak:libX11.so\n";
+}
+
+int main(int argc, char** argv) {
+  gint iteration_count = argc >= 2 ? atoi(argv[1]) : kDefaultIterationCount;
+  if (iteration_count <= 0) {
+    g_printerr("Usage: %s [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!gtk_init_check(&argc, &argv)) {
+    g_printerr("No display available.\n");
+    return EXIT_FAILURE;
+  }
+  gboolean leaked = FALSE;
+  {
+    PluginHarness harness;
+    harness.EnsureInitialized();
+    gtk_widget_show(GTK_WIDGET(harness.window()));
+    harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+    std::vector<RepeatableMethodCall> method_calls = get_repeatable_method_calls();
+    g_print("%-32s %16s\n", "method", "bytes/call");
+    for (const auto& method_call : method_calls) {
+      for (gint i = 0; i < kWarmUpIterationCount; i++) {
+        g_autoptr(FlValue) result = harness.InvokeMethod(method_call.method, method_call.arguments);
+      }
+      size_t before = __sanitizer_get_current_allocated_bytes();
+      for (gint i = 0; i < iteration_count; i++) {
+        g_autoptr(FlValue) result = harness.InvokeMethod(method_call.method, method_call.arguments);
+      }
+      size_t after = __sanitizer_get_current_allocated_bytes();
+      gdouble bytes_per_call = (static_cast<gdouble>(after) - static_cast<gdouble>(before)) / iteration_count;
+      gboolean leaking = bytes_per_call > kMaximumBytesPerCall;
+      g_print("%-32s %16.3f%s\n", method_call.method, bytes_per_call, leaking ? "  LEAK" : "");
+      leaked |= leaking;
+    }
+    free_repeatable_method_calls(method_calls);
+  }
+  return leaked ? EXIT_FAILURE : EXIT_SUCCESS;
+}
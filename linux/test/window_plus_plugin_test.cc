@@ -0,0 +1,741 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gio/gunixsocketaddress.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <gtk/gtk.h>
+#include <unistd.h>
+
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/window_plus/window_plus_plugin.h"
+#include "test/plugin_harness.h"
+
+// Once you have built the plugin's example app, you can run these tests
+// from the command line. For instance, for x64 debug, run:
+// $ xvfb-run build/linux/x64/debug/plugins/window_plus/window_plus_test
+
+namespace window_plus {
+namespace test {
+
+// Keep in sync with the plugin.
+static constexpr gint kWindowStateEventType = 0;
+static constexpr gint kConfigureEventType = 1;
+static constexpr gint kResizeStartedEventType = 2;
+static constexpr gint kResizeEndedEventType = 3;
+static constexpr gint kMoveStartedEventType = 4;
+static constexpr gint kFrameTimingEventType = 6;
+static constexpr guint32 kWindowStateFocused = 8;
+static constexpr guint32 kWindowStateAbove = 32;
+static constexpr guint32 kWindowStateAll = 0x7f;
+static constexpr gint kEventCoalescingNone = 0;
+static constexpr gint kEventCoalescingFrame = 1;
+static constexpr gint kEventCoalescingRate = 2;
+
+// The plugin saves the window state under $HOME/.config (same as Dart), which GLib caches: pointed at a temporary directory once, before
+// any test initializes GTK.
+class TemporaryHomeEnvironment : public ::testing::Environment {
+ public:
+  void SetUp() override { home_ = use_temporary_home(); }
+  void TearDown() override {
+    remove_temporary_home(home_);
+    g_clear_pointer(&home_, g_free);
+  }
+
+ private:
+  gchar* home_ = nullptr;
+};
+
+static ::testing::Environment* const temporary_home_environment = ::testing::AddGlobalTestEnvironment(new TemporaryHomeEnvironment());
+
+static void window_destroy_cb(GtkWidget* widget, gpointer user_data) { *static_cast<gboolean*>(user_data) = TRUE; }
+
+// Tests creating windows need a display, e.g. run them under Xvfb.
+class WindowPlusPluginTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!gtk_init_check(nullptr, nullptr)) {
+      GTEST_SKIP() << "No display available.";
+    }
+  }
+};
+
+TEST_F(WindowPlusPluginTest, EnsureInitializedPublishesStateSnapshot) {
+  PluginHarness harness;
+  gint64 handle = harness.EnsureInitialized();
+  EXPECT_EQ(handle, reinterpret_cast<gint64>(harness.window()));
+  WindowPlusStateSnapshot snapshot;
+  ASSERT_TRUE(window_plus_plugin_copy_state_snapshot_for_window(handle, &snapshot));
+  EXPECT_EQ(snapshot.sequence % 2, 0u);
+  EXPECT_GT(snapshot.scale_factor, 0.0);
+}
+
+TEST_F(WindowPlusPluginTest, CopyStateSnapshotWhileDisposed) {
+  auto harness = std::make_unique<PluginHarness>();
+  gint64 handle = harness->EnsureInitialized();
+  // Same as Dart's UI thread reading the snapshot through FFI.
+  std::atomic<bool> stop(false);
+  std::atomic<guint> copies(0);
+  std::thread reader([&]() {
+    WindowPlusStateSnapshot snapshot;
+    while (!stop.load()) {
+      if (window_plus_plugin_copy_state_snapshot_for_window(handle, &snapshot)) {
+        copies++;
+      }
+    }
+  });
+  while (copies.load() == 0) {
+    harness->Iterate(G_TIME_SPAN_MILLISECOND);
+  }
+  harness.reset();
+  stop.store(true);
+  reader.join();
+  WindowPlusStateSnapshot snapshot;
+  EXPECT_FALSE(window_plus_plugin_copy_state_snapshot_for_window(handle, &snapshot));
+}
+
+TEST_F(WindowPlusPluginTest, SingleInstanceLaunchesAreBatched) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.%d", getpid());
+  PluginHarness harness(application);
+  const gchar* first[] = {"first.txt", nullptr};
+  const gchar* second[] = {"second.txt", nullptr};
+  ASSERT_TRUE(window_plus_plugin_send_single_instance_arguments(application, const_cast<gchar**>(first)));
+  ASSERT_TRUE(window_plus_plugin_send_single_instance_arguments(application, const_cast<gchar**>(second)));
+  g_autoptr(FlValue) arguments = harness.WaitForMethodCall("singleInstanceDataReceived", 5 * G_USEC_PER_SEC);
+  ASSERT_NE(arguments, nullptr);
+  FlValue* launches = fl_value_lookup_string(arguments, "launches");
+  ASSERT_NE(launches, nullptr);
+  ASSERT_EQ(fl_value_get_length(launches), 2u);
+  std::vector<std::string> received;
+  for (size_t i = 0; i < fl_value_get_length(launches); i++) {
+    FlValue* launch = fl_value_get_list_value(launches, i);
+    FlValue* values = fl_value_lookup_string(launch, "arguments");
+    ASSERT_EQ(fl_value_get_length(values), 1u);
+    received.push_back(fl_value_get_string(fl_value_get_list_value(values, 0)));
+    EXPECT_EQ(fl_value_get_type(fl_value_lookup_string(launch, "workingDirectory")), FL_VALUE_TYPE_STRING);
+  }
+  EXPECT_THAT(received, ::testing::UnorderedElementsAre("first.txt", "second.txt"));
+}
+
+TEST_F(WindowPlusPluginTest, SingleInstanceOversizedMessageIsRejected) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.%d", getpid());
+  PluginHarness harness(application);
+  // Same socket as |window_plus_plugin_send_single_instance_arguments|.
+  g_autofree gchar* name = g_strdup_printf("window_plus/%u/%s", getuid(), application);
+  g_autoptr(GSocketAddress) address = g_unix_socket_address_new_with_type(name, -1, G_UNIX_SOCKET_ADDRESS_ABSTRACT);
+  g_autoptr(GSocketClient) client = g_socket_client_new();
+  g_autoptr(GSocketConnection) connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(address), nullptr, nullptr);
+  ASSERT_NE(connection, nullptr);
+  guint32 size = GUINT32_TO_LE(64 * 1024 * 1024);
+  ASSERT_TRUE(g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(connection)), &size, sizeof(size), nullptr, nullptr, nullptr));
+  // Closed by the primary instance, without reading (or allocating) the message.
+  GSocket* socket = g_socket_connection_get_socket(connection);
+  g_socket_set_blocking(socket, FALSE);
+  gchar buffer[16];
+  gssize received = -1;
+  for (gint i = 0; i < 100 && received < 0; i++) {
+    harness.Iterate(10 * G_TIME_SPAN_MILLISECOND);
+    received = g_socket_receive(socket, buffer, sizeof(buffer), nullptr, nullptr);
+  }
+  EXPECT_EQ(received, 0);
+  g_autoptr(FlValue) rejected = harness.WaitForMethodCall("singleInstanceDataReceived", 200 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(rejected, nullptr);
+  // Still serving the other launches.
+  const gchar* arguments[] = {"file.txt", nullptr};
+  ASSERT_TRUE(window_plus_plugin_send_single_instance_arguments(application, const_cast<gchar**>(arguments)));
+  g_autoptr(FlValue) accepted = harness.WaitForMethodCall("singleInstanceDataReceived", 5 * G_USEC_PER_SEC);
+  EXPECT_NE(accepted, nullptr);
+}
+
+TEST_F(WindowPlusPluginTest, GetSizeKeepsZeroOrigin) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_window_move(harness.window(), 120, 80);
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  g_autoptr(FlValue) size = harness.InvokeMethod("getSize");
+  ASSERT_NE(size, nullptr);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(size, "left")), 0);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(size, "top")), 0);
+  gint width = 0, height = 0;
+  gtk_window_get_size(harness.window(), &width, &height);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(size, "width")), width);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(size, "height")), height);
+}
+
+TEST_F(WindowPlusPluginTest, DestroyHidesWindowBeforeSnapshotIsWritten) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.%d", getpid());
+  PluginHarness harness(application);
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  g_autofree gchar* path = g_build_filename(g_get_home_dir(), ".config", application, "WindowSnapshot.RAW", nullptr);
+  gboolean destroyed = FALSE;
+  g_signal_connect(harness.window(), "destroy", G_CALLBACK(window_destroy_cb), &destroyed);
+  g_autoptr(FlValue) result = harness.InvokeMethod("destroy");
+  EXPECT_FALSE(gtk_widget_get_visible(GTK_WIDGET(harness.window())));
+  EXPECT_FALSE(destroyed);
+  for (gint i = 0; i < 100 && !destroyed; i++) {
+    harness.Iterate(10 * G_TIME_SPAN_MILLISECOND);
+  }
+  EXPECT_TRUE(g_file_test(path, G_FILE_TEST_EXISTS));
+  // No GtkApplication to quit, the window itself is destroyed once the snapshot is written.
+  EXPECT_TRUE(destroyed);
+}
+
+// Writes a blank |width| x |height| snapshot of the last session for |application|, the same way the plugin does on destroy.
+static void WriteWindowSnapshot(const gchar* application, gint width, gint height) {
+  g_autofree gchar* directory = g_build_filename(g_get_home_dir(), ".config", application, nullptr);
+  g_mkdir_with_parents(directory, 0755);
+  gint stride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, width);
+  // Header (magic, version, width, height, stride & reserved) & the pixels.
+  std::vector<guint32> contents(8 + stride / sizeof(guint32) * height, 0);
+  contents[0] = 0x53535057;
+  contents[1] = 1;
+  contents[2] = width;
+  contents[3] = height;
+  contents[4] = stride;
+  g_autofree gchar* path = g_build_filename(directory, "WindowSnapshot.RAW", nullptr);
+  ASSERT_TRUE(g_file_set_contents(path, reinterpret_cast<const gchar*>(contents.data()), contents.size() * sizeof(guint32), nullptr));
+}
+
+TEST_F(WindowPlusPluginTest, SnapshotIsShownBeforeFirstFrame) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.%d", getpid());
+  WriteWindowSnapshot(application, 400, 300);
+  PluginHarness harness(application);
+  harness.EnsureInitializedWith({{"pauseWhenOccluded", fl_value_new_bool(TRUE)}});
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_TRUE(gtk_widget_get_visible(GTK_WIDGET(harness.window())));
+  // Not presented until the first frame, occlusion is not tracked meanwhile.
+  g_autoptr(FlValue) profile = harness.InvokeMethod("getStartupProfile");
+  ASSERT_NE(profile, nullptr);
+  EXPECT_EQ(fl_value_lookup_string(profile, "presented"), nullptr);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_FULLY_OBSCURED);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_UNOBSCURED);
+  EXPECT_TRUE(harness.lifecycle_states().empty());
+
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  g_autoptr(FlValue) result = harness.InvokeMethod("notifyFirstFrameRasterized", arguments);
+  g_autoptr(FlValue) presented_profile = harness.InvokeMethod("getStartupProfile");
+  ASSERT_NE(presented_profile, nullptr);
+  EXPECT_NE(fl_value_lookup_string(presented_profile, "presented"), nullptr);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_FULLY_OBSCURED);
+  ASSERT_EQ(harness.lifecycle_states().size(), 1u);
+  EXPECT_EQ(harness.lifecycle_states().back(), "AppLifecycleState.hidden");
+}
+
+// Shows the window & reports the first frame, after which occlusion is tracked.
+static void Present(PluginHarness& harness, gboolean pause_when_occluded) {
+  harness.EnsureInitializedWith({{"pauseWhenOccluded", fl_value_new_bool(pause_when_occluded)}});
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  g_autoptr(FlValue) result = harness.InvokeMethod("notifyFirstFrameRasterized", arguments);
+}
+
+TEST_F(WindowPlusPluginTest, OcclusionPausesAndResumes) {
+  PluginHarness harness;
+  Present(harness, TRUE);
+  EXPECT_TRUE(harness.lifecycle_states().empty());
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_FULLY_OBSCURED);
+  ASSERT_EQ(harness.lifecycle_states().size(), 1u);
+  EXPECT_EQ(harness.lifecycle_states().back(), "AppLifecycleState.hidden");
+  // Partially covered is exposed again.
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_PARTIAL);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_UNOBSCURED);
+  ASSERT_EQ(harness.lifecycle_states().size(), 2u);
+  EXPECT_THAT(harness.lifecycle_states().back(), ::testing::AnyOf("AppLifecycleState.resumed", "AppLifecycleState.inactive"));
+}
+
+TEST_F(WindowPlusPluginTest, WindowStateEventsLeaveLifecycleToEngine) {
+  PluginHarness harness;
+  Present(harness, TRUE);
+  // Minimizing & focus changes are sent by the engine itself.
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_ICONIFIED, GDK_WINDOW_STATE_ICONIFIED);
+  harness.DispatchWindowStateEvent(static_cast<GdkWindowState>(GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_FOCUSED), GDK_WINDOW_STATE_FOCUSED);
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_FOCUSED, static_cast<GdkWindowState>(0));
+  EXPECT_TRUE(harness.lifecycle_states().empty());
+  // Nor while paused for the occlusion.
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_FULLY_OBSCURED);
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_FOCUSED, GDK_WINDOW_STATE_FOCUSED);
+  EXPECT_THAT(harness.lifecycle_states(), ::testing::ElementsAre("AppLifecycleState.hidden"));
+}
+
+TEST_F(WindowPlusPluginTest, OcclusionIsIgnoredWithoutPauseWhenOccluded) {
+  PluginHarness harness;
+  Present(harness, FALSE);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_FULLY_OBSCURED);
+  harness.DispatchVisibilityEvent(GDK_VISIBILITY_UNOBSCURED);
+  EXPECT_TRUE(harness.lifecycle_states().empty());
+}
+
+TEST_F(WindowPlusPluginTest, ConfigureEventRecordLayout) {
+  PluginHarness harness;
+  harness.EnsureInitializedWith({{"eventCoalescing", fl_value_new_int(kEventCoalescingNone)}});
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  harness.SubscribeEvents(kConfigureEventType);
+  gint64 start = g_get_monotonic_time();
+  harness.DispatchConfigureEvent(100, 100, 800, 600);
+  ASSERT_EQ(harness.event_count(kConfigureEventType), 1u);
+  gint64 sequence = harness.last_event(kConfigureEventType).sequence;
+  harness.DispatchConfigureEvent(100, 100, 800, 600);
+  ASSERT_EQ(harness.event_count(kConfigureEventType), 2u);
+  EXPECT_EQ(harness.invalid_event_count(), 0u);
+
+  const EventRecord& record = harness.last_event(kConfigureEventType);
+  gint width = 0, height = 0;
+  gtk_window_get_size(harness.window(), &width, &height);
+  g_autoptr(FlValue) position = harness.InvokeMethod("getPosition");
+  ASSERT_NE(position, nullptr);
+  EXPECT_EQ(record.type, kConfigureEventType);
+  EXPECT_EQ(record.state, 0u);
+  EXPECT_EQ(record.changed, 0u);
+  EXPECT_GT(record.sequence, sequence);
+  EXPECT_GE(record.timestamp, start);
+  EXPECT_LE(record.timestamp, g_get_monotonic_time());
+  EXPECT_EQ(record.x, fl_value_get_int(fl_value_lookup_string(position, "dx")));
+  EXPECT_EQ(record.y, fl_value_get_int(fl_value_lookup_string(position, "dy")));
+  EXPECT_EQ(record.width, width);
+  EXPECT_EQ(record.height, height);
+  EXPECT_GE(record.frame_left, 0);
+  EXPECT_GE(record.frame_top, 0);
+  EXPECT_GE(record.frame_right, 0);
+  EXPECT_GE(record.frame_bottom, 0);
+}
+
+TEST_F(WindowPlusPluginTest, ApplyWindowTransaction) {
+  PluginHarness harness;
+  gint64 handle = harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "minimumWidth", fl_value_new_int(400));
+  fl_value_set_string_take(arguments, "minimumHeight", fl_value_new_int(300));
+  fl_value_set_string_take(arguments, "x", fl_value_new_int(50));
+  fl_value_set_string_take(arguments, "y", fl_value_new_int(60));
+  fl_value_set_string_take(arguments, "width", fl_value_new_int(640));
+  fl_value_set_string_take(arguments, "height", fl_value_new_int(480));
+  g_autoptr(FlValue) result = harness.InvokeMethod("applyWindowTransaction", arguments);
+  // The constraints are in the snapshot right away, the geometry once the window manager has applied it.
+  WindowPlusStateSnapshot snapshot;
+  ASSERT_TRUE(window_plus_plugin_copy_state_snapshot_for_window(handle, &snapshot));
+  EXPECT_EQ(snapshot.minimum_width, 400);
+  EXPECT_EQ(snapshot.minimum_height, 300);
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  gint x = 0, y = 0, width = 0, height = 0;
+  gtk_window_get_position(harness.window(), &x, &y);
+  gtk_window_get_size(harness.window(), &width, &height);
+  EXPECT_EQ(x, 50);
+  EXPECT_EQ(y, 60);
+  EXPECT_EQ(width, 640);
+  EXPECT_EQ(height, 480);
+  ASSERT_TRUE(window_plus_plugin_copy_state_snapshot_for_window(handle, &snapshot));
+  EXPECT_EQ(snapshot.x, 50);
+  EXPECT_EQ(snapshot.y, 60);
+  EXPECT_EQ(snapshot.width, 640);
+  EXPECT_EQ(snapshot.height, 480);
+}
+
+TEST_F(WindowPlusPluginTest, MonitorChangesAreBatched) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  // A burst of property changes, like a monitor reconfiguration.
+  GdkDisplay* display = gtk_widget_get_display(GTK_WIDGET(harness.window()));
+  gint n_monitors = gdk_display_get_n_monitors(display);
+  for (gint i = 0; i < n_monitors; i++) {
+    GdkMonitor* monitor = gdk_display_get_monitor(display, i);
+    g_object_notify(G_OBJECT(monitor), "geometry");
+    g_object_notify(G_OBJECT(monitor), "workarea");
+    g_object_notify(G_OBJECT(monitor), "scale-factor");
+  }
+  g_autoptr(FlValue) monitors = harness.WaitForMethodCall("monitorsChanged", G_USEC_PER_SEC);
+  ASSERT_NE(monitors, nullptr);
+  ASSERT_EQ(fl_value_get_type(monitors), FL_VALUE_TYPE_LIST);
+  EXPECT_EQ(fl_value_get_length(monitors), static_cast<size_t>(n_monitors));
+  g_autoptr(FlValue) again = harness.WaitForMethodCall("monitorsChanged", 100 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(again, nullptr);
+  // Served from the same cache.
+  g_autoptr(FlValue) result = harness.InvokeMethod("getMonitors");
+  ASSERT_NE(result, nullptr);
+  EXPECT_TRUE(fl_value_equal(result, monitors));
+}
+
+TEST_F(WindowPlusPluginTest, DestroyWritesWindowState) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.%d", getpid());
+  PluginHarness harness(application);
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  gtk_window_move(harness.window(), 70, 80);
+  harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  // Still within the debounce interval of the move, the state is written synchronously.
+  g_autoptr(FlValue) result = harness.InvokeMethod("destroy");
+  g_autofree gchar* path = g_build_filename(g_get_home_dir(), ".config", application, "WindowState.JSON", nullptr);
+  g_autofree gchar* contents = nullptr;
+  ASSERT_TRUE(g_file_get_contents(path, &contents, nullptr, nullptr));
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  g_autoptr(FlValue) state = fl_json_message_codec_decode(codec, contents, nullptr);
+  ASSERT_NE(state, nullptr);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(state, "x")), 70);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(state, "y")), 80);
+}
+
+TEST_F(WindowPlusPluginTest, WindowStateEventSendsChangedBits) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  harness.SubscribeEvents(kWindowStateEventType);
+  const auto focused_above = static_cast<GdkWindowState>(GDK_WINDOW_STATE_FOCUSED | GDK_WINDOW_STATE_ABOVE);
+  // Every bit with the first record after subscribing.
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_FOCUSED, focused_above);
+  ASSERT_EQ(harness.event_count(kWindowStateEventType), 1u);
+  EXPECT_EQ(harness.last_event(kWindowStateEventType).state, kWindowStateFocused | kWindowStateAbove);
+  EXPECT_EQ(harness.last_event(kWindowStateEventType).changed, kWindowStateAll);
+  // Nothing forwarded changed, no record.
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_FOCUSED, focused_above);
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_LEFT_RESIZABLE,
+                                   static_cast<GdkWindowState>(GDK_WINDOW_STATE_FOCUSED | GDK_WINDOW_STATE_ABOVE | GDK_WINDOW_STATE_LEFT_RESIZABLE));
+  EXPECT_EQ(harness.event_count(kWindowStateEventType), 1u);
+  // Only the bit which changed.
+  harness.DispatchWindowStateEvent(GDK_WINDOW_STATE_FOCUSED, GDK_WINDOW_STATE_ABOVE);
+  ASSERT_EQ(harness.event_count(kWindowStateEventType), 2u);
+  EXPECT_EQ(harness.last_event(kWindowStateEventType).state, kWindowStateAbove);
+  EXPECT_EQ(harness.last_event(kWindowStateEventType).changed, kWindowStateFocused);
+}
+
+TEST_F(WindowPlusPluginTest, EnsureInitializedTwiceConnectsOnce) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  // e.g. hot restart.
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  gtk_window_close(harness.window());
+  g_autoptr(FlValue) first = harness.WaitForMethodCall("windowCloseReceived", G_USEC_PER_SEC);
+  EXPECT_NE(first, nullptr);
+  g_autoptr(FlValue) second = harness.WaitForMethodCall("windowCloseReceived", 100 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(second, nullptr);
+  // The close is intercepted.
+  EXPECT_TRUE(gtk_widget_get_visible(GTK_WIDGET(harness.window())));
+}
+
+TEST_F(WindowPlusPluginTest, EnsureInitializedWithoutOptions) {
+  PluginHarness harness;
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  g_autoptr(FlValue) result = harness.InvokeMethod("ensureInitialized", arguments);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(fl_value_get_int(result), reinterpret_cast<gint64>(harness.window()));
+}
+
+// Moves the window (without a window manager, right away) & waits for its configure-event.
+static void MoveWindow(PluginHarness& harness, gint x, gint y) {
+  gtk_window_move(harness.window(), x, y);
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+}
+
+TEST_F(WindowPlusPluginTest, FrameTimingFollowsMonitorChanges) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_window_move(harness.window(), 0, 0);
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  ASSERT_GT(gdk_display_get_n_monitors(gdk_display_get_default()), 0);
+  // The current monitor is sent right away, as a change.
+  harness.SubscribeEvents(kFrameTimingEventType);
+  ASSERT_EQ(harness.event_count(kFrameTimingEventType), 1u);
+  EXPECT_EQ(harness.last_event(kFrameTimingEventType).changed, 1u);
+  EXPECT_EQ(harness.last_event(kFrameTimingEventType).x, 0);
+  // Off every monitor & back, without waiting for the window to be painted.
+  guint count = harness.event_count(kFrameTimingEventType);
+  MoveWindow(harness, -5000, -5000);
+  EXPECT_GT(harness.event_count(kFrameTimingEventType), count);
+  EXPECT_EQ(harness.last_event(kFrameTimingEventType).x, -1);
+  count = harness.event_count(kFrameTimingEventType);
+  MoveWindow(harness, 0, 0);
+  EXPECT_GT(harness.event_count(kFrameTimingEventType), count);
+  EXPECT_EQ(harness.last_event(kFrameTimingEventType).x, 0);
+  EXPECT_EQ(harness.invalid_event_count(), 0u);
+}
+
+// Invokes |setCaptionRegions| with the |regions| (|kCaptionRegionFieldCount| integers each) & |removed| IDs, like |WindowCaptionArea|.
+static void SetCaptionRegions(PluginHarness& harness, const std::vector<int32_t>& regions, const std::vector<int32_t>& removed) {
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "regions", fl_value_new_int32_list(regions.data(), regions.size()));
+  fl_value_set_string_take(arguments, "removed", fl_value_new_int32_list(removed.data(), removed.size()));
+  g_autoptr(FlValue) result = harness.InvokeMethod("setCaptionRegions", arguments);
+}
+
+TEST_F(WindowPlusPluginTest, CaptionRegionsHitTest) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  // A 32 pixels tall caption with a no-drag button at its right end.
+  SetCaptionRegions(harness, {1, 1, 0, 0, 800, 32, 2, 0, 760, 0, 40, 32}, {});
+  EXPECT_TRUE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 10, 10));
+  EXPECT_TRUE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 759, 31));
+  EXPECT_FALSE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 770, 10));
+  EXPECT_FALSE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 10, 32));
+  EXPECT_FALSE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), -1, 10));
+  // The button is gone, the caption under it drags again.
+  SetCaptionRegions(harness, {}, {2});
+  EXPECT_TRUE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 770, 10));
+  // Replaced by ID: the caption shrinks.
+  SetCaptionRegions(harness, {1, 1, 0, 0, 400, 32}, {});
+  EXPECT_TRUE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 399, 10));
+  EXPECT_FALSE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 400, 10));
+  SetCaptionRegions(harness, {}, {1});
+  EXPECT_FALSE(window_plus_plugin_hit_test_caption_regions(harness.plugin(), 10, 10));
+}
+
+TEST_F(WindowPlusPluginTest, CustomFrameResizeEdges) {
+  PluginHarness harness;
+  harness.EnsureInitializedWith({{"enableCustomFrame", fl_value_new_bool(TRUE)}});
+  gtk_window_resize(harness.window(), 400, 300);
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  gint width = gtk_widget_get_allocated_width(GTK_WIDGET(harness.window()));
+  gint height = gtk_widget_get_allocated_height(GTK_WIDGET(harness.window()));
+  ASSERT_GT(width, 12);
+  ASSERT_GT(height, 12);
+  // Left 1, right 2, top 4 & bottom 8 within the 6 pixels wide border.
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 0, 0), 1 | 4);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width - 1, 0), 2 | 4);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 0, height - 1), 1 | 8);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width - 1, height - 1), 2 | 8);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 5, height / 2), 1);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width - 6, height / 2), 2);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width / 2, 5), 4);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width / 2, height - 6), 8);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 6, height / 2), 0);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), width / 2, height / 2), 0);
+  gtk_window_set_resizable(harness.window(), FALSE);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 0, 0), 0);
+}
+
+TEST_F(WindowPlusPluginTest, ResizeEdgesRequireCustomFrame) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(window_plus_plugin_get_resize_edges(harness.plugin(), 0, 0), 0);
+}
+
+// A burst of configure-event(s) changing the size, like a window manager resizing the window interactively.
+static void DispatchResizeBurst(PluginHarness& harness) {
+  harness.DispatchConfigureEvent(100, 100, 700, 500);
+  harness.DispatchConfigureEvent(100, 100, 710, 510);
+  harness.DispatchConfigureEvent(100, 100, 720, 520);
+}
+
+TEST_F(WindowPlusPluginTest, ConfigureEventBurstIsLiveResize) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  harness.SubscribeEvents(kResizeStartedEventType);
+  DispatchResizeBurst(harness);
+  EXPECT_EQ(harness.event_count(kResizeStartedEventType), 1u);
+  EXPECT_EQ(harness.last_event(kResizeStartedEventType).width, 710);
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(harness.event_count(kResizeEndedEventType), 1u);
+  EXPECT_EQ(harness.last_event(kResizeEndedEventType).width, 720);
+}
+
+TEST_F(WindowPlusPluginTest, WindowTransactionIsNotLiveOperation) {
+  PluginHarness harness;
+  harness.EnsureInitialized();
+  gtk_widget_show(GTK_WIDGET(harness.window()));
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  harness.SubscribeEvents(kResizeStartedEventType);
+  harness.SubscribeEvents(kMoveStartedEventType);
+  g_autoptr(FlValue) arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "width", fl_value_new_int(700));
+  fl_value_set_string_take(arguments, "height", fl_value_new_int(500));
+  g_autoptr(FlValue) result = harness.InvokeMethod("applyWindowTransaction", arguments);
+  // e.g. the window manager animating the new geometry.
+  DispatchResizeBurst(harness);
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(harness.event_count(kResizeStartedEventType), 0u);
+  EXPECT_EQ(harness.event_count(kMoveStartedEventType), 0u);
+}
+
+// Configure-event(s) arriving all at once i.e. faster than any coalescing interval.
+class WindowPlusPluginCoalescingTest : public WindowPlusPluginTest {
+ protected:
+  static constexpr gint kFloodEventCount = 50;
+
+  // Shows the window, subscribes to configure-event(s) & dispatches |kFloodEventCount| of them.
+  static void Flood(PluginHarness& harness, gint event_coalescing, gint event_coalescing_rate = 60) {
+    harness.EnsureInitializedWith(
+        {{"eventCoalescing", fl_value_new_int(event_coalescing)}, {"eventCoalescingRate", fl_value_new_int(event_coalescing_rate)}});
+    gtk_widget_show(GTK_WIDGET(harness.window()));
+    harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+    harness.SubscribeEvents(kConfigureEventType);
+    for (gint i = 0; i < kFloodEventCount; i++) {
+      harness.DispatchConfigureEvent(100 + i, 100, 800, 600);
+    }
+  }
+
+  static gint64 GetDroppedEventCount(PluginHarness& harness) {
+    g_autoptr(FlValue) result = harness.InvokeMethod("getDroppedEventCount");
+    return result != nullptr ? fl_value_get_int(result) : -1;
+  }
+};
+
+TEST_F(WindowPlusPluginCoalescingTest, NoneSendsEveryEvent) {
+  PluginHarness harness;
+  Flood(harness, kEventCoalescingNone);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), static_cast<guint>(kFloodEventCount));
+  EXPECT_EQ(GetDroppedEventCount(harness), 0);
+}
+
+TEST_F(WindowPlusPluginCoalescingTest, FrameSendsOncePerTick) {
+  PluginHarness harness;
+  Flood(harness, kEventCoalescingFrame);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 0u);
+  harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 1u);
+  EXPECT_EQ(GetDroppedEventCount(harness), kFloodEventCount - 1);
+}
+
+TEST_F(WindowPlusPluginCoalescingTest, RateSendsOncePerInterval) {
+  PluginHarness harness;
+  // 500 ms interval: the first event is sent right away, the second one is held for the rest of the interval.
+  Flood(harness, kEventCoalescingRate, 2);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 1u);
+  EXPECT_EQ(GetDroppedEventCount(harness), kFloodEventCount - 2);
+  harness.Iterate(600 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 2u);
+}
+
+TEST_F(WindowPlusPluginCoalescingTest, PolicyChangeSendsPendingEventOnce) {
+  PluginHarness harness;
+  Flood(harness, kEventCoalescingFrame);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 0u);
+  harness.EnsureInitializedWith({{"eventCoalescing", fl_value_new_int(kEventCoalescingRate)}});
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 1u);
+  // The tick callback of the previous policy is gone.
+  harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(harness.event_count(kConfigureEventType), 1u);
+  EXPECT_EQ(harness.invalid_event_count(), 0u);
+}
+
+// Resize synchronization (X11 only) keeps the window frozen after a resize until Dart reports a frame at the new size. The view stands in
+// for the FlView, the frames are reported the way Dart does.
+class WindowPlusPluginResizeSyncTest : public WindowPlusPluginTest {
+ protected:
+  void SetUp() override {
+    WindowPlusPluginTest::SetUp();
+    if (IsSkipped()) {
+      return;
+    }
+#ifdef GDK_WINDOWING_X11
+    if (GDK_IS_X11_DISPLAY(gdk_display_get_default())) {
+      return;
+    }
+#endif
+    GTEST_SKIP() << "Resize synchronization is X11 only.";
+  }
+
+  // Shows the window & reports the first frame at its size.
+  static void Present(PluginHarness& harness) {
+    harness.EnsureInitialized();
+    gtk_widget_show(GTK_WIDGET(harness.window()));
+    harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+    g_autoptr(FlValue) arguments = GetViewSize(harness);
+    g_autoptr(FlValue) result = harness.InvokeMethod("notifyFirstFrameRasterized", arguments);
+    harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  }
+
+  // Resizes the window & waits for the new size to be allocated to the view i.e. for the window to be frozen.
+  static void Resize(PluginHarness& harness, gint width, gint height) {
+    gtk_window_resize(harness.window(), width, height);
+    for (gint i = 0; i < 100 && gtk_widget_get_allocated_width(harness.view()) != width; i++) {
+      harness.Iterate(5 * G_TIME_SPAN_MILLISECOND);
+    }
+    ASSERT_EQ(gtk_widget_get_allocated_width(harness.view()), width);
+  }
+
+  // Physical size of the view, as reported by Dart.
+  static FlValue* GetViewSize(PluginHarness& harness) {
+    gint scale_factor = gtk_widget_get_scale_factor(harness.view());
+    FlValue* result = fl_value_new_map();
+    fl_value_set_string_take(result, "width", fl_value_new_int(gtk_widget_get_allocated_width(harness.view()) * scale_factor));
+    fl_value_set_string_take(result, "height", fl_value_new_int(gtk_widget_get_allocated_height(harness.view()) * scale_factor));
+    return result;
+  }
+
+  static void NotifyFrameRasterized(PluginHarness& harness, gint64 raster_finish) {
+    g_autoptr(FlValue) arguments = GetViewSize(harness);
+    fl_value_set_string_take(arguments, "rasterFinish", fl_value_new_int(raster_finish));
+    g_autoptr(FlValue) result = harness.InvokeMethod("notifyFrameRasterized", arguments);
+  }
+
+  static void NotifyFrameBuilt(PluginHarness& harness) {
+    g_autoptr(FlValue) arguments = GetViewSize(harness);
+    g_autoptr(FlValue) result = harness.InvokeMethod("notifyFrameBuilt", arguments);
+  }
+
+  static gint64 GetMismatchedResizeFrameCount(PluginHarness& harness) {
+    g_autoptr(FlValue) result = harness.InvokeMethod("getMismatchedResizeFrameCount");
+    return result != nullptr ? fl_value_get_int(result) : -1;
+  }
+};
+
+TEST_F(WindowPlusPluginResizeSyncTest, NoFrameAtNewSizeIsMismatched) {
+  PluginHarness harness;
+  Present(harness);
+  Resize(harness, 640, 480);
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(GetMismatchedResizeFrameCount(harness), 1);
+}
+
+TEST_F(WindowPlusPluginResizeSyncTest, FrameRasterizedWhileFrozenIsNotMismatched) {
+  PluginHarness harness;
+  Present(harness);
+  Resize(harness, 640, 480);
+  NotifyFrameRasterized(harness, window_plus_plugin_get_monotonic_time());
+  harness.Iterate(300 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(GetMismatchedResizeFrameCount(harness), 0);
+}
+
+TEST_F(WindowPlusPluginResizeSyncTest, FrameRasterizedAfterThawIsMismatched) {
+  PluginHarness harness;
+  Present(harness);
+  Resize(harness, 640, 480);
+  NotifyFrameBuilt(harness);
+  // Thawed a refresh interval after the frame was built.
+  harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  NotifyFrameRasterized(harness, window_plus_plugin_get_monotonic_time());
+  EXPECT_EQ(GetMismatchedResizeFrameCount(harness), 1);
+}
+
+TEST_F(WindowPlusPluginResizeSyncTest, FrameRasterizedBeforeThawIsNotMismatched) {
+  PluginHarness harness;
+  Present(harness);
+  Resize(harness, 640, 480);
+  gint64 raster_finish = window_plus_plugin_get_monotonic_time();
+  NotifyFrameBuilt(harness);
+  harness.Iterate(100 * G_TIME_SPAN_MILLISECOND);
+  // Reported late (batched), after the thaw.
+  NotifyFrameRasterized(harness, raster_finish);
+  harness.Iterate(200 * G_TIME_SPAN_MILLISECOND);
+  EXPECT_EQ(GetMismatchedResizeFrameCount(harness), 0);
+}
+
+TEST(WindowPlusPluginSingleInstanceTest, NoPrimaryInstance) {
+  g_autofree gchar* application = g_strdup_printf("window_plus_test.missing.%d", getpid());
+  const gchar* arguments[] = {"file.txt", nullptr};
+  EXPECT_FALSE(window_plus_plugin_send_single_instance_arguments(application, const_cast<gchar**>(arguments)));
+}
+
+}  // namespace test
+}  // namespace window_plus
@@ -6,302 +6,2175 @@
 
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
+#include <unistd.h>
+
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
 
 #include <iostream>
+#include <vector>
+
+#include "window_plus_placement.h"
+#include "window_plus_plugin_private.h"
 
 // TODO(alexmercerind): Refactor to use GObject.
 
-static constexpr auto kMethodChannelName = "com.alexmercerind/window_plus";
+static constexpr auto kMethodChannelName = "com.alexmercerind/window_plus";
+static constexpr auto kEventChannelName = "com.alexmercerind/window_plus/events";
+// Flutter's own lifecycle channel, see |update_occlusion|.
+static constexpr auto kLifecycleChannelName = "flutter/lifecycle";
+
+// Common:
+
+static constexpr auto kEnsureInitializedMethodName = "ensureInitialized";
+static constexpr auto kGetMinimumSizeMethodName = "getMinimumSize";
+static constexpr auto kSetMinimumSizeMethodName = "setMinimumSize";
+static constexpr auto kWindowCloseReceivedMethodName = "windowCloseReceived";
+static constexpr auto kNotifyFirstFrameRasterizedMethodName = "notifyFirstFrameRasterized";
+static constexpr auto kSingleInstanceDataReceivedMethodName = "singleInstanceDataReceived";
+static constexpr auto kGetStateMethodName = "getState";
+static constexpr auto kCloseMethodName = "close";
+static constexpr auto kDestroyMethodName = "destroy";
+static constexpr auto kGetIsMinimizedMethodName = "getMinimized";
+static constexpr auto kGetIsMaximizedMethodName = "getMaximized";
+static constexpr auto kGetIsFullscreenMethodName = "getIsFullscreen";
+static constexpr auto kGetSizeMethodName = "getSize";
+static constexpr auto kGetPositionMethodName = "getPosition";
+static constexpr auto kGetMonitorsMethodName = "getMonitors";
+static constexpr auto kSetIsFullscreenMethodName = "setIsFullscreen";
+static constexpr auto kMaximizeMethodName = "maximize";
+static constexpr auto kRestoreMethodName = "restore";
+static constexpr auto kMinimizeMethodName = "minimize";
+static constexpr auto kMoveMethodName = "move";
+static constexpr auto kResizeMethodName = "resize";
+static constexpr auto kHideMethodName = "hide";
+static constexpr auto kShowMethodName = "show";
+static constexpr auto kGetDroppedEventCountMethodName = "getDroppedEventCount";
+static constexpr auto kNotifyFrameBuiltMethodName = "notifyFrameBuilt";
+static constexpr auto kNotifyFrameRasterizedMethodName = "notifyFrameRasterized";
+static constexpr auto kGetMismatchedResizeFrameCountMethodName = "getMismatchedResizeFrameCount";
+static constexpr auto kApplyWindowTransactionMethodName = "applyWindowTransaction";
+static constexpr auto kMonitorsChangedMethodName = "monitorsChanged";
+static constexpr auto kGetSavedWindowStateMethodName = "getSavedWindowState";
+static constexpr auto kGetStartupProfileMethodName = "getStartupProfile";
+static constexpr auto kSubscribeEventsMethodName = "subscribeEvents";
+static constexpr auto kUnsubscribeEventsMethodName = "unsubscribeEvents";
+static constexpr auto kSetCaptionRegionsMethodName = "setCaptionRegions";
+
+// GTK Exclusives:
+
+// Types of |WindowPlusEventRecord| sent over |kEventChannelName|. Keep in sync with Dart.
+
+static constexpr auto kWindowStateEventType = 0;
+static constexpr auto kConfigureEventType = 1;
+static constexpr auto kResizeStartedEventType = 2;
+static constexpr auto kResizeEndedEventType = 3;
+static constexpr auto kMoveStartedEventType = 4;
+static constexpr auto kMoveEndedEventType = 5;
+// Sent after every frame painted by GTK while subscribed & when the window moves to another monitor. |timestamp| is the presentation time
+// of the last frame (or the predicted one, if unknown), |x| is the index of the window's monitor, |width| is the refresh interval in
+// microseconds & |changed| is 1 if the monitor changed since the last record. See |send_frame_timing_event|.
+static constexpr auto kFrameTimingEventType = 6;
+
+// Bits of |WindowPlusEventRecord::state|. Keep in sync with Dart.
+
+static constexpr auto kWindowStateMinimized = 1 << 0;
+static constexpr auto kWindowStateMaximized = 1 << 1;
+static constexpr auto kWindowStateFullscreen = 1 << 2;
+static constexpr auto kWindowStateFocused = 1 << 3;
+static constexpr auto kWindowStateTiled = 1 << 4;
+static constexpr auto kWindowStateAbove = 1 << 5;
+static constexpr auto kWindowStateOccluded = 1 << 6;
+static constexpr auto kWindowStateAll =
+    kWindowStateMinimized | kWindowStateMaximized | kWindowStateFullscreen | kWindowStateFocused | kWindowStateTiled | kWindowStateAbove | kWindowStateOccluded;
+
+// Fixed-layout record sent over |kEventChannelName| for every window event. All fields are little-endian.
+// Decoded on the Dart side with |ByteData| views, no per-field map lookups or |FlStandardMessageCodec| encoding.
+typedef struct {
+  int32_t type;
+  uint32_t state;
+  int64_t sequence;
+  // Monotonic time in microseconds i.e. |g_get_monotonic_time|.
+  int64_t timestamp;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  // Bit-mask of |kWindowState*| values changed since the last |kWindowStateEventType| record. 0 for other types.
+  uint32_t changed;
+  int32_t reserved;
+  // Client-side decoration (shadow & resize border) around the |width| x |height| window, 0 with server-side decorations.
+  int32_t frame_left;
+  int32_t frame_top;
+  int32_t frame_right;
+  int32_t frame_bottom;
+} WindowPlusEventRecord;
+
+static_assert(sizeof(WindowPlusEventRecord) == 64, "WindowPlusEventRecord layout must match the Dart decoder.");
+
+// TODO (alexmercerind): Expose in public API.
+
+static constexpr auto kMonitorSafeArea = 8;
+static constexpr auto kWindowDefaultWidth = 1280;
+static constexpr auto kWindowDefaultHeight = 720;
+static constexpr auto kWindowStateFileName = "WindowState.JSON";
+// Downscaled snapshot of the window contents, stored next to |kWindowStateFileName|. See |save_window_snapshot|.
+static constexpr auto kWindowSnapshotFileName = "WindowSnapshot.RAW";
+static constexpr auto kWindowSnapshotMagic = 0x53535057;  // "WPSS"
+static constexpr auto kWindowSnapshotVersion = 1;
+static constexpr auto kWindowSnapshotScale = 0.5;
+// Delay after the last window-state-event/configure-event before the window state is written to |kWindowStateFileName|.
+static constexpr auto kSaveWindowStateDebounceInterval = 500;
+
+// Single instance server, see |start_single_instance_server|.
+
+// Launches received within this interval (in milliseconds) are delivered to Dart together.
+static constexpr auto kSingleInstanceBatchInterval = 50;
+// |GVariant| sent by the secondary instances i.e. working directory, arguments & |kSingleInstanceEnvironmentHints|.
+static constexpr auto kSingleInstanceMessageType = "(sasa{ss})";
+// The message is preceded by its size (32-bit, little-endian). Larger messages are rejected & the connection is closed if the message is
+// not received within the timeout (in milliseconds), so that a stalled or misbehaving client holds neither memory nor the connection.
+static constexpr gsize kSingleInstanceMaximumMessageSize = 1024 * 1024;
+static constexpr auto kSingleInstanceConnectionTimeout = 5000;
+static constexpr const gchar* kSingleInstanceEnvironmentHints[] = {"DESKTOP_STARTUP_ID", "XDG_ACTIVATION_TOKEN"};
+
+// Interactive (live) move or resize in progress, see |begin_live_operation|.
+
+static constexpr auto kLiveOperationNone = 0;
+static constexpr auto kLiveOperationMove = 1;
+static constexpr auto kLiveOperationResize = 2;
+// A live operation ends when no configure-event is received for this interval (in milliseconds). Two configure-events changing the
+// geometry within this interval start one.
+static constexpr auto kLiveOperationIdleInterval = 200;
+
+// Maximum time (in milliseconds) the window manager is kept waiting for a Flutter frame at the new size, see |begin_resize_sync|.
+static constexpr auto kResizeSyncTimeout = 100;
+// Refresh interval (in microseconds) assumed if the monitor's refresh rate is not known.
+static constexpr auto kDefaultRefreshInterval = 16667;
+
+// Caption regions pushed from Dart as |kCaptionRegionFieldCount| integers each i.e. ID, drag (1) or no-drag (0), left, top, width & height
+// in |FlView| coordinates. See |caption_pressed_cb|.
+static constexpr auto kCaptionRegionFieldCount = 6;
+
+// Bit values of the custom frame resize edges, combined at the corners. Same hit-testing as |WM_NCHITTEST| on Windows.
+
+static constexpr auto kResizeEdgeLeft = 1 << 0;
+static constexpr auto kResizeEdgeRight = 1 << 1;
+static constexpr auto kResizeEdgeTop = 1 << 2;
+static constexpr auto kResizeEdgeBottom = 1 << 3;
+// Width of the resize border (in logical pixels) inside the edges of the custom frame.
+static constexpr auto kResizeBorderSize = 6;
+
+// Startup phases recorded by |record_startup_phase|, in order. |kStartupPhaseNames| are the keys sent to Dart.
+
+static constexpr auto kStartupPhaseRegisterWithRegistrar = 0;
+static constexpr auto kStartupPhaseMonitorsCached = 1;
+static constexpr auto kStartupPhaseRegistered = 2;
+static constexpr auto kStartupPhaseEnsureInitialized = 3;
+static constexpr auto kStartupPhaseStyleLoaded = 4;
+static constexpr auto kStartupPhasePlacementRestored = 5;
+static constexpr auto kStartupPhaseEnsureInitializedCompleted = 6;
+static constexpr auto kStartupPhaseFirstFrameRasterized = 7;
+static constexpr auto kStartupPhasePresented = 8;
+static constexpr auto kStartupPhaseCount = 9;
+
+static constexpr const gchar* kStartupPhaseNames[kStartupPhaseCount] = {
+    "registerWithRegistrar", "monitorsCached", "registered", "ensureInitialized", "styleLoaded", "placementRestored", "ensureInitializedCompleted", "firstFrameRasterized", "presented",
+};
+
+// If set, the startup profile is dumped as JSON when the window is first presented. "1" prints it to stderr, any other value is used as
+// the path of the file to write it to.
+static constexpr auto kStartupProfileEnvironmentVariable = "WINDOW_PLUS_STARTUP_PROFILE";
+
+// Policies for coalescing configure-event(s) before sending to Dart. Keep in sync with |WindowEventCoalescing| in Dart.
+
+static constexpr auto kEventCoalescingNone = 0;
+static constexpr auto kEventCoalescingFrame = 1;
+static constexpr auto kEventCoalescingRate = 2;
+static constexpr auto kEventCoalescingDefaultRate = 60;
+
+// Header of |kWindowSnapshotFileName|, followed by |height| rows of |stride| bytes of |CAIRO_FORMAT_RGB24| pixels (native-endian).
+// The pixels are used in-place from the memory-mapped file.
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  int32_t width;
+  int32_t height;
+  int32_t stride;
+  int32_t reserved[3];
+} WindowSnapshotHeader;
+
+static_assert(sizeof(WindowSnapshotHeader) == 32, "WindowSnapshotHeader must keep the pixels 4-byte aligned.");
+
+// Window caption (or excluded no-drag) region, see |update_caption_regions|.
+typedef struct {
+  gint64 id;
+  gboolean drag;
+  GdkRectangle rect;
+} CaptionRegion;
+
+// Entry of the cached monitor table. See |update_monitors|.
+typedef struct {
+  GdkMonitor* monitor;
+  GdkRectangle workarea;
+  GdkRectangle bounds;
+  gint scale_factor;
+  // In milli-Hertz, 0 if unknown.
+  gint refresh_rate;
+} MonitorInfo;
+
+// A batch of window operations, applied together by |apply_window_transaction|.
+typedef struct {
+  gboolean has_position;
+  gint x;
+  gint y;
+  gboolean has_size;
+  gint width;
+  gint height;
+  gboolean has_minimum_size;
+  gint minimum_width;
+  gint minimum_height;
+  // -1 if unchanged, FALSE or TRUE otherwise.
+  gint maximized;
+  gint fullscreen;
+  gint minimized;
+} WindowTransaction;
+
+#define WINDOW_PLUS_PLUGIN(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), window_plus_plugin_get_type(), WindowPlusPlugin))
+
+// One instance per |FlView| i.e. per window, registered in |windows|.
+struct _WindowPlusPlugin {
+  GObject parent_instance;
+  FlPluginRegistrar* registrar;
+  // Cached |FlView| & its toplevel |GtkWindow|, see |get_window|. |id| is the key in |windows|.
+  GtkWidget* view;
+  GtkWindow* window;
+  gint64 id;
+  FlMethodChannel* channel;
+  FlBasicMessageChannel* event_channel;
+  // Whether the window is fully covered by other windows (X11 visibility-notify-event), whether Flutter is told to stop rendering meanwhile
+  // (i.e. |AppLifecycleState.hidden| is sent) & whether it should be. See |update_occlusion|.
+  gboolean obscured;
+  gboolean occluded;
+  gboolean pause_when_occluded;
+  FlBasicMessageChannel* lifecycle_channel;
+  gboolean enable_event_streams;
+  // Whether the signal handlers of |kEnsureInitializedMethodName| are connected.
+  gboolean initialized;
+  // Number of Dart streams listening to each of the |kWindowStateEventType| & |kConfigureEventType| events & the IDs of the signal
+  // handlers, connected only while the count is non-zero. See |subscribe_events|.
+  gint window_state_event_subscriptions;
+  gulong window_state_event_handler_id;
+  gint configure_event_subscriptions;
+  gulong configure_event_handler_id;
+  // Number of Dart streams listening to the |kResizeStartedEventType|, |kMoveStartedEventType| etc. events.
+  gint live_operation_event_subscriptions;
+  // Number of Dart streams listening to the |kFrameTimingEventType| events, the |GdkFrameClock| of the window & its after-paint handler.
+  gint frame_timing_event_subscriptions;
+  GdkFrameClock* frame_clock;
+  gulong frame_clock_handler_id;
+  // Monitor index sent with the last |kFrameTimingEventType| record, -1 if none is sent yet.
+  gint frame_timing_monitor;
+  // Current |kLiveOperation*|, its idle timeout source ID & the last geometry reported by configure-event.
+  gint live_operation;
+  guint live_operation_source_id;
+  GdkRectangle last_geometry;
+  gint64 last_geometry_time;
+  // Live operations are not detected from the configure-event(s) until this (monotonic) time. See |suppress_live_operation_detection|.
+  gint64 live_operation_suppressed_until;
+  // Caption regions sent from Dart, the capture-phase gesture hit-testing them & the time of the last press (for double-click detection).
+  GArray* caption_regions;
+  GtkGesture* caption_gesture;
+  guint32 last_caption_press_time;
+  // Whether the window is undecorated & resized from the |kResizeEdge*| bits under the pointer, tracked by |frame_motion_controller|.
+  gboolean custom_frame;
+  gint resize_edges;
+  GtkEventController* frame_motion_controller;
+  // Cached monitor table & the encoded |kGetMonitorsMethodName| reply, kept up to date from |GdkDisplay| & |GdkMonitor| signals.
+  GdkDisplay* display;
+  GArray* monitors;
+  FlValue* monitors_value;
+  guint monitors_source_id;
+  gint64 event_sequence;
+  gint event_coalescing;
+  gint event_coalescing_rate;
+  // Tick callback ID (|kEventCoalescingFrame|) & timeout source ID (|kEventCoalescingRate|) of the pending (coalesced) configure-event.
+  // Kept apart since each is removed differently. 0 if none is pending.
+  guint configure_event_tick_id;
+  guint configure_event_source_id;
+  gint64 last_configure_event_time;
+  // Monotonic time at which the latest configure-event was received, sent with the (coalesced) event.
+  gint64 configure_event_time;
+  guint64 dropped_event_count;
+  // Resize synchronization (X11 only), see |begin_resize_sync|. Sizes are in physical pixels i.e. same as Dart's |FlutterView.physicalSize|.
+  gboolean resize_sync_enabled;
+  gboolean resize_sync_frozen;
+  guint resize_sync_source_id;
+  gint resize_sync_width;
+  gint resize_sync_height;
+  gint frame_width;
+  gint frame_height;
+  guint64 mismatched_resize_frame_count;
+  // Time & size of the last thaw on a built (not yet rasterized) frame, checked against its |rasterFinish|. See |notify_frame_rasterized|.
+  gint64 resize_sync_thaw_time;
+  gint resize_sync_thawed_width;
+  gint resize_sync_thawed_height;
+  // |kWindowState*| bits sent with the last |kWindowStateEventType| record, -1 if none is sent yet.
+  gint64 last_sent_state;
+  WindowPlusStateSnapshot snapshot;
+  // Saved window state read natively from |kWindowStateFileName|. See |load_saved_window_state|.
+  gboolean has_saved_state;
+  window_plus::PlacementState saved_state;
+  // Whether |restore_window_placement| has already been called.
+  gboolean placement_restored;
+  // Path of |kWindowStateFileName| & the debounce timeout source ID. See |save_window_state|.
+  gchar* state_file_path;
+  guint save_source_id;
+  gint64 last_state_change_time;
+  // Snapshot of the last session, painted in place of the |FlView| until the first frame is rasterized. See |show_window_snapshot|.
+  GMappedFile* snapshot_file;
+  cairo_surface_t* snapshot_surface;
+  gulong snapshot_draw_handler_id;
+  guint snapshot_source_id;
+  // Single instance server & the launches waiting to be delivered to Dart together, see |queue_single_instance_launch|.
+  GSocketService* single_instance_service;
+  FlValue* pending_launches;
+  guint launches_source_id;
+  // Whether the window is presented when the pending launches are delivered & the startup hint to present it with, see
+  // |present_single_instance_window|.
+  gboolean pending_present;
+  gchar* pending_startup_id;
+  // Monotonic time (|g_get_monotonic_time|) of each startup phase, 0 if not reached yet.
+  gint64 startup_profile[kStartupPhaseCount];
+};
+
+G_DEFINE_TYPE(WindowPlusPlugin, window_plus_plugin, g_object_get_type())
+
+// First registered instance i.e. the main window. Receives |kSingleInstanceDataReceivedMethodName|.
+WindowPlusPlugin* plugin = nullptr;
+
+// Registry of all the instances, keyed by window ID i.e. the |GtkWindow| address (same as the handle returned by
+// |kEnsureInitializedMethodName|). Used to address the process-wide C API (e.g. the FFI state snapshot) by window. Only changed on the GTK
+// thread, but read from the Dart UI thread through FFI: changes & the other threads' reads hold the |windows| lock, an instance is removed
+// (while holding it) before it is freed.
+GHashTable* windows = nullptr;
+G_LOCK_DEFINE_STATIC(windows);
+
+// Application identifier set by |window_plus_plugin_set_application|, used to locate the saved window state before the Dart VM starts.
+gchar* application_id = nullptr;
+
+// Removes |plugin| from |windows| once its |GtkWindow| is finalized, so that its ID (i.e. address) is not addressable anymore & can be
+// re-used by another window.
+static void window_weak_notify(gpointer user_data, GObject* where_the_object_was) {
+  WindowPlusPlugin* plugin = static_cast<WindowPlusPlugin*>(user_data);
+  G_LOCK(windows);
+  if (windows != nullptr && g_hash_table_lookup(windows, &plugin->id) == plugin) {
+    g_hash_table_remove(windows, &plugin->id);
+  }
+  G_UNLOCK(windows);
+  plugin->window = nullptr;
+}
+
+// Returns the toplevel |GtkWindow| of the |FlView| of |plugin|. Looked up once (the |FlView| may not be added to a window yet at the time
+// of registration) & cached, after which the instance is also added to |windows|.
+static GtkWindow* get_window(WindowPlusPlugin* plugin) {
+  if (plugin->window == nullptr) {
+    GtkWidget* toplevel = gtk_widget_get_toplevel(plugin->view);
+    if (!GTK_IS_WINDOW(toplevel)) {
+      return nullptr;
+    }
+    plugin->window = GTK_WINDOW(toplevel);
+    g_object_weak_ref(G_OBJECT(plugin->window), window_weak_notify, plugin);
+    plugin->id = reinterpret_cast<gint64>(plugin->window);
+    // Replace the key too, it points into the instance which owns the entry.
+    G_LOCK(windows);
+    g_hash_table_replace(windows, &plugin->id, plugin);
+    G_UNLOCK(windows);
+  }
+  return plugin->window;
+}
+
+// Records the monotonic time of |phase|. Only the first occurrence is kept.
+static void record_startup_phase(WindowPlusPlugin* plugin, gint phase) {
+  if (plugin->startup_profile[phase] == 0) {
+    plugin->startup_profile[phase] = g_get_monotonic_time();
+  }
+}
+
+// Returns the reached startup phases as a map of |kStartupPhaseNames| to monotonic time in microseconds.
+static FlValue* startup_profile_to_value(WindowPlusPlugin* plugin) {
+  FlValue* result = fl_value_new_map();
+  for (gint i = 0; i < kStartupPhaseCount; i++) {
+    if (plugin->startup_profile[i] > 0) {
+      fl_value_set_string_take(result, kStartupPhaseNames[i], fl_value_new_int(plugin->startup_profile[i]));
+    }
+  }
+  return result;
+}
+
+static void dump_startup_profile(WindowPlusPlugin* plugin) {
+  const gchar* destination = g_getenv(kStartupProfileEnvironmentVariable);
+  if (destination == nullptr || *destination == '\0') {
+    return;
+  }
+  g_autoptr(FlValue) value = startup_profile_to_value(plugin);
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  g_autofree gchar* contents = fl_json_message_codec_encode(codec, value, nullptr);
+  if (contents == nullptr) {
+    return;
+  }
+  if (g_strcmp0(destination, "1") == 0) {
+    g_printerr("%s\n", contents);
+  } else if (!g_file_set_contents(destination, contents, -1, nullptr)) {
+    g_warning("Failed to write startup profile to %s", destination);
+  }
+}
+
+static GdkPoint get_cursor_position() {
+  GdkDisplay* display = gdk_display_get_default();
+  GdkSeat* seat = gdk_display_get_default_seat(display);
+  GdkDevice* device = gdk_seat_get_pointer(seat);
+  GdkPoint position = GdkPoint{0, 0};
+  gdk_device_get_position(device, NULL, &position.x, &position.y);
+  return position;
+}
+
+static FlValue* rectangle_to_value(const GdkRectangle* rectangle) {
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "left", fl_value_new_int(rectangle->x));
+  fl_value_set_string_take(result, "top", fl_value_new_int(rectangle->y));
+  fl_value_set_string_take(result, "width", fl_value_new_int(rectangle->width));
+  fl_value_set_string_take(result, "height", fl_value_new_int(rectangle->height));
+  return result;
+}
+
+static void monitor_changed_cb(GdkMonitor* monitor, GParamSpec* pspec, gpointer user_data);
+
+// Re-builds the cached monitor table & the |kGetMonitorsMethodName| reply.
+static void update_monitors(WindowPlusPlugin* plugin) {
+  for (guint i = 0; i < plugin->monitors->len; i++) {
+    MonitorInfo* info = &g_array_index(plugin->monitors, MonitorInfo, i);
+    g_signal_handlers_disconnect_by_data(info->monitor, plugin);
+    g_object_unref(info->monitor);
+  }
+  g_array_set_size(plugin->monitors, 0);
+  g_clear_pointer(&plugin->monitors_value, fl_value_unref);
+  plugin->monitors_value = fl_value_new_list();
+  gint n_monitors = gdk_display_get_n_monitors(plugin->display);
+  for (gint i = 0; i < n_monitors; i++) {
+    MonitorInfo info;
+    info.monitor = GDK_MONITOR(g_object_ref(gdk_display_get_monitor(plugin->display, i)));
+    gdk_monitor_get_workarea(info.monitor, &info.workarea);
+    gdk_monitor_get_geometry(info.monitor, &info.bounds);
+    info.scale_factor = gdk_monitor_get_scale_factor(info.monitor);
+    info.refresh_rate = gdk_monitor_get_refresh_rate(info.monitor);
+    g_array_append_val(plugin->monitors, info);
+    g_signal_connect(info.monitor, "notify::workarea", G_CALLBACK(monitor_changed_cb), plugin);
+    g_signal_connect(info.monitor, "notify::geometry", G_CALLBACK(monitor_changed_cb), plugin);
+    g_signal_connect(info.monitor, "notify::scale-factor", G_CALLBACK(monitor_changed_cb), plugin);
+    g_signal_connect(info.monitor, "notify::refresh-rate", G_CALLBACK(monitor_changed_cb), plugin);
+
+    FlValue* fl_monitor = fl_value_new_map();
+    fl_value_set_string_take(fl_monitor, "workarea", rectangle_to_value(&info.workarea));
+    fl_value_set_string_take(fl_monitor, "bounds", rectangle_to_value(&info.bounds));
+    fl_value_set_string_take(fl_monitor, "scaleFactor", fl_value_new_float((gdouble)info.scale_factor));
+    fl_value_set_string_take(fl_monitor, "refreshRate", fl_value_new_float(info.refresh_rate / 1000.0));
+    fl_value_append_take(plugin->monitors_value, fl_monitor);
+  }
+}
+
+static gboolean update_monitors_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->monitors_source_id = 0;
+  update_monitors(plugin);
+  if (plugin->enable_event_streams) {
+    fl_method_channel_invoke_method(plugin->channel, kMonitorsChangedMethodName, plugin->monitors_value, nullptr, nullptr, nullptr);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Monitor changes usually arrive in bursts (e.g. geometry, workarea & scale-factor together), re-build the table once when idle.
+static void schedule_update_monitors(WindowPlusPlugin* plugin) {
+  if (plugin->monitors_source_id == 0) {
+    plugin->monitors_source_id = g_idle_add(update_monitors_cb, plugin);
+  }
+}
+
+static void monitor_changed_cb(GdkMonitor* monitor, GParamSpec* pspec, gpointer user_data) { schedule_update_monitors(WINDOW_PLUS_PLUGIN(user_data)); }
+
+static void monitor_added_cb(GdkDisplay* display, GdkMonitor* monitor, gpointer user_data) { schedule_update_monitors(WINDOW_PLUS_PLUGIN(user_data)); }
+
+static void monitor_removed_cb(GdkDisplay* display, GdkMonitor* monitor, gpointer user_data) { schedule_update_monitors(WINDOW_PLUS_PLUGIN(user_data)); }
+
+// Returns the index of the monitor in the cached monitor table which has the largest intersection with |rectangle|, -1 if none. Same as
+// |gdk_display_get_monitor_at_window|, without querying the display server on every configure-event.
+static gint find_monitor_at_rectangle(WindowPlusPlugin* plugin, const GdkRectangle* rectangle) {
+  gint result = -1, result_area = 0;
+  for (guint i = 0; i < plugin->monitors->len; i++) {
+    GdkRectangle intersection;
+    if (gdk_rectangle_intersect(rectangle, &g_array_index(plugin->monitors, MonitorInfo, i).bounds, &intersection) && intersection.width * intersection.height > result_area) {
+      result = i;
+      result_area = intersection.width * intersection.height;
+    }
+  }
+  return result;
+}
+
+// Looks up the workarea of the monitor under the mouse |cursor| (or the first one) from the cached monitor table.
+static gboolean get_cursor_monitor_workarea(WindowPlusPlugin* plugin, GdkPoint cursor, GdkRectangle* workarea) {
+  if (plugin->monitors->len == 0) {
+    return FALSE;
+  }
+  *workarea = g_array_index(plugin->monitors, MonitorInfo, 0).workarea;
+  for (guint i = 0; i < plugin->monitors->len; i++) {
+    MonitorInfo* info = &g_array_index(plugin->monitors, MonitorInfo, i);
+    if (cursor.x >= info->bounds.x && cursor.x < info->bounds.x + info->bounds.width && cursor.y >= info->bounds.y && cursor.y < info->bounds.y + info->bounds.height) {
+      *workarea = info->workarea;
+      break;
+    }
+  }
+  return !(workarea->x == 0 && workarea->y == 0 && workarea->width == 0 && workarea->height == 0);
+}
+
+static gint get_default_window_width(const GdkRectangle* workarea) {
+  if (workarea != nullptr) {
+    gint monitor_width = workarea->width - 96;
+    if (kWindowDefaultWidth > monitor_width) {
+      return monitor_width;
+    }
+  }
+  return kWindowDefaultWidth;
+}
+
+static gint get_default_window_height(const GdkRectangle* workarea) {
+  if (workarea != nullptr) {
+    gint monitor_height = workarea->height - 96;
+    if (kWindowDefaultHeight > monitor_height) {
+      return monitor_height;
+    }
+  }
+  return kWindowDefaultHeight;
+}
+
+static window_plus::PlacementRect rectangle_to_placement_rect(const GdkRectangle* rectangle) {
+  return window_plus::PlacementRect{rectangle->x, rectangle->y, rectangle->width, rectangle->height};
+}
+
+// Computes the final geometry & state of the window from the cached monitor table & the |saved| state (may be nullptr) using the
+// shared placement engine. The result is applied at once using |apply_window_transaction|.
+static WindowTransaction compute_window_placement(WindowPlusPlugin* plugin, const window_plus::PlacementState* saved, GdkPoint cursor, gint default_width, gint default_height) {
+  std::vector<window_plus::PlacementMonitor> monitors;
+  monitors.reserve(plugin->monitors->len);
+  for (guint i = 0; i < plugin->monitors->len; i++) {
+    MonitorInfo* info = &g_array_index(plugin->monitors, MonitorInfo, i);
+    window_plus::PlacementMonitor monitor;
+    monitor.bounds = rectangle_to_placement_rect(&info->bounds);
+    monitor.workarea = rectangle_to_placement_rect(&info->workarea);
+    // GTK coordinates are already logical.
+    monitor.scale_factor = 1.0;
+    monitors.emplace_back(monitor);
+  }
+  window_plus::PlacementOptions options;
+  options.safe_area = kMonitorSafeArea;
+  options.default_width = default_width;
+  options.default_height = default_height;
+  options.cursor_x = cursor.x;
+  options.cursor_y = cursor.y;
+  window_plus::PlacementState placement = window_plus::ComputeWindowPlacement(monitors, saved, options);
+  WindowTransaction transaction = {};
+  transaction.has_position = TRUE;
+  transaction.x = placement.rect.x;
+  transaction.y = placement.rect.y;
+  transaction.has_size = TRUE;
+  transaction.width = placement.rect.width;
+  transaction.height = placement.rect.height;
+  transaction.has_minimum_size = FALSE;
+  transaction.maximized = placement.maximized ? TRUE : -1;
+  transaction.fullscreen = -1;
+  transaction.minimized = -1;
+  return transaction;
+}
+
+static guint32 window_state_to_bits(GdkWindowState window_state) {
+  guint32 state = 0;
+  if (window_state & GDK_WINDOW_STATE_ICONIFIED) {
+    state |= kWindowStateMinimized;
+  }
+  if (window_state & GDK_WINDOW_STATE_MAXIMIZED) {
+    state |= kWindowStateMaximized;
+  }
+  if (window_state & GDK_WINDOW_STATE_FULLSCREEN) {
+    state |= kWindowStateFullscreen;
+  }
+  if (window_state & GDK_WINDOW_STATE_FOCUSED) {
+    state |= kWindowStateFocused;
+  }
+  if (window_state & GDK_WINDOW_STATE_TILED) {
+    state |= kWindowStateTiled;
+  }
+  if (window_state & GDK_WINDOW_STATE_ABOVE) {
+    state |= kWindowStateAbove;
+  }
+  return state;
+}
+
+// |window_state_to_bits| with |kWindowStateOccluded| i.e. not visible at all, either minimized, withdrawn (e.g. on another workspace) or
+// fully covered by other windows.
+static guint32 get_window_state_bits(WindowPlusPlugin* plugin, GdkWindowState window_state) {
+  guint32 state = window_state_to_bits(window_state);
+  if ((window_state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)) || plugin->obscured) {
+    state |= kWindowStateOccluded;
+  }
+  return state;
+}
+
+// |requested_position| & |requested_size| are the geometry just requested from the window manager, if any. Used in place of the current
+// one, so that the getters reflect a |kMoveMethodName| or |kResizeMethodName| right away, before the configure-event arrives.
+static void update_state_snapshot(WindowPlusPlugin* plugin, const GdkPoint* requested_position = nullptr, const GtkRequisition* requested_size = nullptr) {
+  GtkWindow* window = get_window(plugin);
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  guint32 state = 0;
+  gint x = -1, y = -1, width = 0, height = 0, minimum_width = -1, minimum_height = -1, monitor = -1;
+  gdouble scale_factor = 1.0;
+  gtk_window_get_position(window, &x, &y);
+  gtk_window_get_size(window, &width, &height);
+  gtk_widget_get_size_request(GTK_WIDGET(window), &minimum_width, &minimum_height);
+  if (gdk_window != nullptr) {
+    state = get_window_state_bits(plugin, gdk_window_get_state(gdk_window));
+    scale_factor = gdk_window_get_scale_factor(gdk_window);
+  }
+  if (requested_position != nullptr) {
+    x = requested_position->x;
+    y = requested_position->y;
+  }
+  if (requested_size != nullptr) {
+    width = requested_size->width;
+    height = requested_size->height;
+  }
+  if (gdk_window != nullptr) {
+    GdkRectangle rectangle = GdkRectangle{x, y, width, height};
+    monitor = find_monitor_at_rectangle(plugin, &rectangle);
+  }
+  // Sequence lock: make |sequence| odd, write the fields & make |sequence| even again.
+  WindowPlusStateSnapshot* snapshot = &plugin->snapshot;
+  __atomic_store_n(&snapshot->sequence, snapshot->sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&snapshot->state, state, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->x, x, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->y, y, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->width, width, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->height, height, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->minimum_width, minimum_width, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->minimum_height, minimum_height, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->monitor, monitor, __ATOMIC_RELAXED);
+  __atomic_store(&snapshot->scale_factor, &scale_factor, __ATOMIC_RELAXED);
+  __atomic_store_n(&snapshot->sequence, snapshot->sequence + 1, __ATOMIC_RELEASE);
+}
+
+static gboolean lookup_int(FlValue* map, const gchar* key, gint* value) {
+  FlValue* result = fl_value_lookup_string(map, key);
+  if (result == nullptr) {
+    return FALSE;
+  }
+  if (fl_value_get_type(result) == FL_VALUE_TYPE_INT) {
+    *value = (gint)fl_value_get_int(result);
+    return TRUE;
+  }
+  if (fl_value_get_type(result) == FL_VALUE_TYPE_FLOAT) {
+    *value = (gint)fl_value_get_float(result);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static gint lookup_bool(FlValue* map, const gchar* key) {
+  FlValue* result = fl_value_lookup_string(map, key);
+  if (result == nullptr || fl_value_get_type(result) != FL_VALUE_TYPE_BOOL) {
+    return -1;
+  }
+  return fl_value_get_bool(result);
+}
+
+static WindowTransaction window_transaction_from_value(FlValue* value) {
+  WindowTransaction transaction = {};
+  transaction.has_position = lookup_int(value, "x", &transaction.x) && lookup_int(value, "y", &transaction.y);
+  transaction.has_size = lookup_int(value, "width", &transaction.width) && lookup_int(value, "height", &transaction.height);
+  transaction.has_minimum_size = lookup_int(value, "minimumWidth", &transaction.minimum_width) && lookup_int(value, "minimumHeight", &transaction.minimum_height);
+  transaction.maximized = lookup_bool(value, "maximized");
+  transaction.fullscreen = lookup_bool(value, "fullscreen");
+  transaction.minimized = lookup_bool(value, "minimized");
+  return transaction;
+}
+
+// The configure-event(s) caused by the plugin itself (transactions, |kMoveMethodName| etc.) & by the window manager changing the state
+// (e.g. a maximize animation) are not an interactive operation. Suppresses the detection in |update_live_operation| meanwhile.
+static void suppress_live_operation_detection(WindowPlusPlugin* plugin) {
+  plugin->live_operation_suppressed_until = g_get_monotonic_time() + kLiveOperationIdleInterval * 1000;
+}
+
+static gboolean thaw_updates_cb(gpointer user_data) {
+  gdk_window_thaw_updates(GDK_WINDOW(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// Applies all the operations of |transaction| to |window| at once. The |GdkWindow| is frozen until the main loop is idle i.e. after
+// GTK's next layout, so none of the intermediate states are ever painted.
+static void apply_window_transaction(WindowPlusPlugin* plugin, GtkWindow* window, const WindowTransaction* transaction) {
+  suppress_live_operation_detection(plugin);
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (gdk_window != nullptr) {
+    gdk_window_freeze_updates(gdk_window);
+  }
+  // Constraints first, so that the new geometry is validated against them.
+  if (transaction->has_minimum_size) {
+    gtk_widget_set_size_request(GTK_WIDGET(window), transaction->minimum_width, transaction->minimum_height);
+  }
+  // Leave fullscreen/maximized/minimized states before changing the geometry, the window manager ignores it otherwise.
+  if (transaction->fullscreen == FALSE) {
+    gtk_window_unfullscreen(window);
+  }
+  if (transaction->maximized == FALSE) {
+    gtk_window_unmaximize(window);
+  }
+  if (transaction->minimized == FALSE) {
+    gtk_window_deiconify(window);
+  }
+  if (transaction->has_size) {
+    gtk_window_resize(window, transaction->width, transaction->height);
+  }
+  if (transaction->has_position) {
+    gint width = 0, height = 0;
+    gtk_window_get_size(window, &width, &height);
+    if (transaction->has_size && gtk_widget_get_mapped(GTK_WIDGET(window)) && gdk_window_get_width(gdk_window) == width && gdk_window_get_height(gdk_window) == height) {
+      // No client-side decorations i.e. |GdkWindow| & |GtkWindow| geometry is same. Send a single move-resize request to the window
+      // manager instead of a move now & a resize on GTK's next layout. |gtk_window_resize| above only keeps GTK's bookkeeping in sync.
+      gdk_window_move_resize(gdk_window, transaction->x, transaction->y, transaction->width, transaction->height);
+    } else {
+      // Unmapped |window| only stores the position, it is applied together with the size when mapped.
+      gtk_window_move(window, transaction->x, transaction->y);
+    }
+  }
+  if (transaction->maximized == TRUE) {
+    gtk_window_maximize(window);
+  }
+  if (transaction->fullscreen == TRUE) {
+    gtk_window_fullscreen(window);
+  }
+  if (transaction->minimized == TRUE) {
+    gtk_window_iconify(window);
+  }
+  if (gdk_window != nullptr) {
+    g_idle_add_full(G_PRIORITY_LOW, thaw_updates_cb, g_object_ref(gdk_window), g_object_unref);
+  }
+  update_state_snapshot(plugin);
+}
+
+// Reads & parses the saved window state from ~/.config/<application>/WindowState.JSON i.e. same path as |WindowState.getStoragePath|.
+// The same path is used by |save_window_state| afterwards.
+static gboolean load_saved_window_state(WindowPlusPlugin* plugin, const gchar* application) {
+  g_free(plugin->state_file_path);
+  plugin->state_file_path = g_build_filename(g_get_home_dir(), ".config", application, kWindowStateFileName, nullptr);
+  // Created once here, the window state & the snapshot are always written to the same directory.
+  g_autofree gchar* directory = g_path_get_dirname(plugin->state_file_path);
+  g_mkdir_with_parents(directory, 0755);
+  g_autofree gchar* contents = nullptr;
+  if (!g_file_get_contents(plugin->state_file_path, &contents, nullptr, nullptr)) {
+    return FALSE;
+  }
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  g_autoptr(FlValue) value = fl_json_message_codec_decode(codec, contents, nullptr);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_MAP) {
+    return FALSE;
+  }
+  window_plus::PlacementState saved;
+  if (!(lookup_int(value, "x", &saved.rect.x) && lookup_int(value, "y", &saved.rect.y) && lookup_int(value, "width", &saved.rect.width) &&
+        lookup_int(value, "height", &saved.rect.height))) {
+    return FALSE;
+  }
+  saved.maximized = lookup_bool(value, "maximized") == TRUE;
+  plugin->saved_state = saved;
+  plugin->has_saved_state = TRUE;
+  return TRUE;
+}
+
+// Sets the default size of |window| & restores the saved position & size if |window| is within bounds of any of the monitors,
+// otherwise centers it on the monitor under the mouse cursor. The final geometry & maximized state are computed in one step & applied
+// at once, before |window| is mapped.
+static void restore_window_placement(WindowPlusPlugin* plugin, GtkWindow* window) {
+  // Query the mouse cursor only once, the workarea is looked up from the cached monitor table.
+  GdkPoint cursor = get_cursor_position();
+  GdkRectangle cursor_workarea = GdkRectangle{0, 0, 0, 0};
+  gboolean cursor_workarea_available = get_cursor_monitor_workarea(plugin, cursor, &cursor_workarea);
+  gint default_width = get_default_window_width(cursor_workarea_available ? &cursor_workarea : nullptr);
+  gint default_height = get_default_window_height(cursor_workarea_available ? &cursor_workarea : nullptr);
+  gtk_window_set_default_size(window, default_width, default_height);
+  GdkGeometry geometry;
+  geometry.base_width = default_width;
+  geometry.base_height = default_height;
+  gtk_window_set_geometry_hints(window, GTK_WIDGET(window), &geometry, static_cast<GdkWindowHints>(GDK_HINT_BASE_SIZE));
+  WindowTransaction transaction = compute_window_placement(plugin, plugin->has_saved_state ? &plugin->saved_state : nullptr, cursor, default_width, default_height);
+  apply_window_transaction(plugin, window, &transaction);
+  plugin->placement_restored = TRUE;
+  record_startup_phase(plugin, kStartupPhasePlacementRestored);
+}
+
+static FlValue* saved_window_state_to_value(WindowPlusPlugin* plugin) {
+  if (!plugin->has_saved_state) {
+    return fl_value_new_null();
+  }
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "x", fl_value_new_int(plugin->saved_state.rect.x));
+  fl_value_set_string_take(result, "y", fl_value_new_int(plugin->saved_state.rect.y));
+  fl_value_set_string_take(result, "width", fl_value_new_int(plugin->saved_state.rect.width));
+  fl_value_set_string_take(result, "height", fl_value_new_int(plugin->saved_state.rect.height));
+  fl_value_set_string_take(result, "maximized", fl_value_new_bool(plugin->saved_state.maximized));
+  return result;
+}
+
+// Updates |saved_state| from the current |window| state. Position & size are only updated in the normal state i.e. the restored
+// geometry is kept while the window is maximized, fullscreen or minimized. The geometry is taken from |snapshot| (already updated for the
+// same event), |gdk_window_get_state| is cached by GDK i.e. no round trip to the display server.
+static void update_saved_state(WindowPlusPlugin* plugin) {
+  GtkWindow* window = get_window(plugin);
+  GdkWindow* gdk_window = window != nullptr ? gtk_widget_get_window(GTK_WIDGET(window)) : nullptr;
+  if (gdk_window == nullptr) {
+    return;
+  }
+  GdkWindowState state = gdk_window_get_state(gdk_window);
+  if (state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_FULLSCREEN | GDK_WINDOW_STATE_WITHDRAWN)) {
+    return;
+  }
+  gboolean maximized = state & GDK_WINDOW_STATE_MAXIMIZED;
+  if (!maximized) {
+    plugin->saved_state.rect = window_plus::PlacementRect{plugin->snapshot.x, plugin->snapshot.y, plugin->snapshot.width, plugin->snapshot.height};
+    plugin->has_saved_state = TRUE;
+  }
+  plugin->saved_state.maximized = maximized;
+}
+
+static gchar* encode_saved_window_state(WindowPlusPlugin* plugin) {
+  g_autoptr(FlValue) value = saved_window_state_to_value(plugin);
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  return fl_json_message_codec_encode(codec, value, nullptr);
+}
+
+// Generation of the latest window state write started (main thread only) & of the one last written to the file. Writes are serialized by
+// the lock, a write older than the one already in the file is skipped i.e. a stale write still queued on a worker thread never lands
+// over a newer one.
+G_LOCK_DEFINE_STATIC(window_state_file);
+static gint64 window_state_generation = 0;
+static gint64 window_state_file_generation = 0;
+
+typedef struct {
+  gchar* path;
+  gchar* contents;
+  gint64 generation;
+} WindowStateWrite;
+
+static void window_state_write_free(gpointer data) {
+  WindowStateWrite* write = static_cast<WindowStateWrite*>(data);
+  g_free(write->path);
+  g_free(write->contents);
+  g_free(write);
+}
+
+// |g_file_set_contents| writes to a temporary file & renames it over the destination, so the file is never left half-written e.g. on crash.
+static void write_window_state(const gchar* path, const gchar* contents, gint64 generation) {
+  G_LOCK(window_state_file);
+  if (generation > window_state_file_generation) {
+    g_autoptr(GError) error = nullptr;
+    if (!g_file_set_contents(path, contents, -1, &error)) {
+      g_warning("Failed to save window state: %s", error->message);
+    }
+    window_state_file_generation = generation;
+  }
+  G_UNLOCK(window_state_file);
+}
+
+static void write_window_state_thread(GTask* task, gpointer source_object, gpointer task_data, GCancellable* cancellable) {
+  WindowStateWrite* write = static_cast<WindowStateWrite*>(task_data);
+  write_window_state(write->path, write->contents, write->generation);
+}
+
+// Writes |saved_state| to |state_file_path| on a GIO worker thread.
+static void save_window_state(WindowPlusPlugin* plugin) {
+  if (plugin->state_file_path == nullptr || !plugin->has_saved_state) {
+    return;
+  }
+  g_autofree gchar* contents = encode_saved_window_state(plugin);
+  if (contents == nullptr) {
+    return;
+  }
+  WindowStateWrite* write = g_new0(WindowStateWrite, 1);
+  write->path = g_strdup(plugin->state_file_path);
+  write->contents = g_steal_pointer(&contents);
+  write->generation = ++window_state_generation;
+  g_autoptr(GTask) task = g_task_new(nullptr, nullptr, nullptr, nullptr);
+  g_task_set_task_data(task, write, window_state_write_free);
+  g_task_run_in_thread(task, write_window_state_thread);
+}
+
+static gboolean save_window_state_timeout_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->save_source_id = 0;
+  // Changed again meanwhile, wait for the rest of the interval after the last change.
+  gint64 remaining = kSaveWindowStateDebounceInterval - (g_get_monotonic_time() - plugin->last_state_change_time) / 1000;
+  if (remaining > 0) {
+    plugin->save_source_id = g_timeout_add(remaining, save_window_state_timeout_cb, plugin);
+    return G_SOURCE_REMOVE;
+  }
+  save_window_state(plugin);
+  return G_SOURCE_REMOVE;
+}
+
+// The window state is written |kSaveWindowStateDebounceInterval| after the last change. The timeout is only started once per burst (not
+// re-armed on every configure-event), |save_window_state_timeout_cb| extends it if needed.
+static void schedule_save_window_state(WindowPlusPlugin* plugin) {
+  if (plugin->state_file_path == nullptr) {
+    return;
+  }
+  update_saved_state(plugin);
+  plugin->last_state_change_time = g_get_monotonic_time();
+  if (plugin->save_source_id == 0) {
+    plugin->save_source_id = g_timeout_add(kSaveWindowStateDebounceInterval, save_window_state_timeout_cb, plugin);
+  }
+}
+
+// Writes the window state synchronously. Used only when the window is about to be destroyed, where nothing else is left to block. Waits
+// for the write in progress on a worker thread (if any), the ones still queued are skipped.
+static void flush_window_state(WindowPlusPlugin* plugin) {
+  if (plugin->state_file_path == nullptr) {
+    return;
+  }
+  if (plugin->save_source_id > 0) {
+    g_source_remove(plugin->save_source_id);
+    plugin->save_source_id = 0;
+  }
+  update_saved_state(plugin);
+  if (!plugin->has_saved_state) {
+    return;
+  }
+  g_autofree gchar* contents = encode_saved_window_state(plugin);
+  if (contents == nullptr) {
+    return;
+  }
+  write_window_state(plugin->state_file_path, contents, ++window_state_generation);
+}
+
+static gchar* get_window_snapshot_path(WindowPlusPlugin* plugin) {
+  g_autofree gchar* directory = g_path_get_dirname(plugin->state_file_path);
+  return g_build_filename(directory, kWindowSnapshotFileName, nullptr);
+}
+
+// Captures a downscaled snapshot of the window contents & writes it to |kWindowSnapshotFileName| on a GIO worker thread (atomically, same
+// as |save_window_state|). Only called once the close is confirmed, so a cancelled close costs nothing. Reading back from the |GdkWindow|
+// works with software rendering, the snapshot is simply not shown on the next launch if it fails. Returns TRUE if the write started,
+// |callback| is invoked with its result. Returns FALSE otherwise, without invoking |callback|.
+static gboolean save_window_snapshot(WindowPlusPlugin* plugin, GAsyncReadyCallback callback, gpointer user_data) {
+  if (plugin->state_file_path == nullptr || !gtk_widget_get_visible(plugin->view)) {
+    return FALSE;
+  }
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(get_window(plugin)));
+  if (gdk_window == nullptr || !gdk_window_is_viewable(gdk_window) || (gdk_window_get_state(gdk_window) & GDK_WINDOW_STATE_ICONIFIED)) {
+    return FALSE;
+  }
+  gint width = static_cast<gint>(gdk_window_get_width(gdk_window) * kWindowSnapshotScale);
+  gint height = static_cast<gint>(gdk_window_get_height(gdk_window) * kWindowSnapshotScale);
+  if (width <= 0 || height <= 0) {
+    return FALSE;
+  }
+  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+  cairo_t* cr = cairo_create(surface);
+  cairo_scale(cr, kWindowSnapshotScale, kWindowSnapshotScale);
+  gdk_cairo_set_source_window(cr, gdk_window, 0, 0);
+  cairo_paint(cr);
+  cairo_destroy(cr);
+  cairo_surface_flush(surface);
+  gboolean started = FALSE;
+  if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) {
+    WindowSnapshotHeader header = {};
+    header.magic = kWindowSnapshotMagic;
+    header.version = kWindowSnapshotVersion;
+    header.width = width;
+    header.height = height;
+    header.stride = cairo_image_surface_get_stride(surface);
+    gsize size = sizeof(WindowSnapshotHeader) + static_cast<gsize>(header.stride) * height;
+    gchar* contents = static_cast<gchar*>(g_malloc(size));
+    memcpy(contents, &header, sizeof(WindowSnapshotHeader));
+    memcpy(contents + sizeof(WindowSnapshotHeader), cairo_image_surface_get_data(surface), size - sizeof(WindowSnapshotHeader));
+    g_autoptr(GBytes) bytes = g_bytes_new_take(contents, size);
+    g_autofree gchar* path = get_window_snapshot_path(plugin);
+    g_autoptr(GFile) file = g_file_new_for_path(path);
+    g_file_replace_contents_bytes_async(file, bytes, nullptr, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, nullptr, callback, user_data);
+    started = TRUE;
+  }
+  cairo_surface_destroy(surface);
+  return started;
+}
+
+// Quits the GtkApplication of |window| or destroys |window| if it has none (e.g. the runner uses |gtk_main| & quits when it is destroyed).
+static void destroy_window(GtkWindow* window) {
+  GtkApplication* application = gtk_window_get_application(window);
+  if (application != nullptr) {
+    g_application_quit(G_APPLICATION(application));
+  } else {
+    gtk_widget_destroy(GTK_WIDGET(window));
+  }
+}
+
+// |user_data| is the (referenced) |GtkWindow|, hidden until the snapshot is written.
+static void window_snapshot_saved_cb(GObject* source, GAsyncResult* result, gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  if (!g_file_replace_contents_finish(G_FILE(source), result, nullptr, &error)) {
+    g_warning("Failed to save window snapshot: %s", error->message);
+  }
+  destroy_window(GTK_WINDOW(user_data));
+  g_object_unref(user_data);
+}
+
+// Maps |kWindowSnapshotFileName| & wraps the pixels in a cairo surface, without copying.
+static gboolean load_window_snapshot(WindowPlusPlugin* plugin) {
+  if (plugin->state_file_path == nullptr) {
+    return FALSE;
+  }
+  g_autofree gchar* path = get_window_snapshot_path(plugin);
+  GMappedFile* file = g_mapped_file_new(path, FALSE, nullptr);
+  if (file == nullptr) {
+    return FALSE;
+  }
+  gsize size = g_mapped_file_get_length(file);
+  gchar* contents = g_mapped_file_get_contents(file);
+  WindowSnapshotHeader header;
+  if (size < sizeof(WindowSnapshotHeader)) {
+    g_mapped_file_unref(file);
+    return FALSE;
+  }
+  memcpy(&header, contents, sizeof(WindowSnapshotHeader));
+  if (header.magic != kWindowSnapshotMagic || header.version != kWindowSnapshotVersion || header.width <= 0 || header.height <= 0 ||
+      header.stride != cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, header.width) || size < sizeof(WindowSnapshotHeader) + static_cast<gsize>(header.stride) * header.height) {
+    g_mapped_file_unref(file);
+    return FALSE;
+  }
+  plugin->snapshot_file = file;
+  plugin->snapshot_surface = cairo_image_surface_create_for_data(reinterpret_cast<unsigned char*>(contents + sizeof(WindowSnapshotHeader)), CAIRO_FORMAT_RGB24, header.width,
+                                                                 header.height, header.stride);
+  return TRUE;
+}
+
+static gboolean window_snapshot_draw_cb(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(widget, &allocation);
+  cairo_save(cr);
+  cairo_scale(cr, static_cast<gdouble>(allocation.width) / cairo_image_surface_get_width(plugin->snapshot_surface),
+              static_cast<gdouble>(allocation.height) / cairo_image_surface_get_height(plugin->snapshot_surface));
+  cairo_set_source_surface(cr, plugin->snapshot_surface, 0, 0);
+  cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+  cairo_paint(cr);
+  cairo_restore(cr);
+  // The |FlView| is not shown yet, nothing else to draw.
+  return TRUE;
+}
+
+static gboolean show_window_snapshot_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->snapshot_source_id = 0;
+  GtkWindow* window = get_window(plugin);
+  if (window != nullptr && plugin->snapshot_surface != nullptr) {
+    gtk_widget_show(GTK_WIDGET(window));
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Shows the |window| right away (at the restored geometry) with the snapshot of the last session painted in place of the |FlView|,
+// instead of nothing during the whole engine startup. Shown once the main loop is idle i.e. after the runner is done with the |window|.
+// Swapped out by |hide_window_snapshot| when the first frame is rasterized. |kStartupPhasePresented| is only recorded then i.e. occlusion
+// tracking & single instance presentation deliberately stay off while the snapshot is shown, the |FlView| is not rendering yet.
+static void show_window_snapshot(WindowPlusPlugin* plugin, GtkWindow* window) {
+  if (!load_window_snapshot(plugin)) {
+    return;
+  }
+  plugin->snapshot_draw_handler_id = g_signal_connect(window, "draw", G_CALLBACK(window_snapshot_draw_cb), plugin);
+  plugin->snapshot_source_id = g_idle_add_full(G_PRIORITY_HIGH_IDLE, show_window_snapshot_cb, plugin, nullptr);
+}
+
+static void hide_window_snapshot(WindowPlusPlugin* plugin) {
+  if (plugin->snapshot_source_id > 0) {
+    g_source_remove(plugin->snapshot_source_id);
+    plugin->snapshot_source_id = 0;
+  }
+  if (plugin->snapshot_draw_handler_id > 0) {
+    if (plugin->window != nullptr) {
+      g_signal_handler_disconnect(plugin->window, plugin->snapshot_draw_handler_id);
+    }
+    plugin->snapshot_draw_handler_id = 0;
+  }
+  g_clear_pointer(&plugin->snapshot_surface, cairo_surface_destroy);
+  g_clear_pointer(&plugin->snapshot_file, g_mapped_file_unref);
+}
+
+// Returns the ordering & timing information sent with every method channel event i.e. same as |WindowPlusEventRecord|.
+static FlValue* event_metadata_to_value(WindowPlusPlugin* plugin) {
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "sequence", fl_value_new_int(++plugin->event_sequence));
+  fl_value_set_string_take(result, "timestamp", fl_value_new_int(g_get_monotonic_time()));
+  return result;
+}
+
+// Name of the abstract Unix socket of the single instance server. Per user & |application|.
+static gchar* get_single_instance_socket_name(const gchar* application) { return g_strdup_printf("window_plus/%u/%s", getuid(), application); }
+
+static FlValue* single_instance_launch_to_value(const gchar* working_directory, const gchar* const* arguments, GVariant* environment) {
+  FlValue* result = fl_value_new_map();
+  FlValue* values = fl_value_new_list();
+  for (gint i = 0; arguments != nullptr && arguments[i] != nullptr; i++) {
+    fl_value_append_take(values, fl_value_new_string(arguments[i]));
+  }
+  fl_value_set_string_take(result, "arguments", values);
+  fl_value_set_string_take(result, "workingDirectory", working_directory != nullptr ? fl_value_new_string(working_directory) : fl_value_new_null());
+  FlValue* hints = fl_value_new_map();
+  if (environment != nullptr) {
+    GVariantIter iter;
+    const gchar* key = nullptr;
+    const gchar* value = nullptr;
+    g_variant_iter_init(&iter, environment);
+    while (g_variant_iter_next(&iter, "{&s&s}", &key, &value)) {
+      fl_value_set_string_take(hints, key, fl_value_new_string(value));
+    }
+  }
+  fl_value_set_string_take(result, "environment", hints);
+  return result;
+}
+
+// Brings the window to the front for the launches received over the single instance socket, like GApplication's activation does. The
+// activation token (or startup notification ID) of the latest launch lets the window manager / compositor focus the window.
+static void present_single_instance_window(WindowPlusPlugin* plugin) {
+  plugin->pending_present = FALSE;
+  g_autofree gchar* startup_id = g_steal_pointer(&plugin->pending_startup_id);
+  GtkWindow* window = get_window(plugin);
+  if (window == nullptr) {
+    return;
+  }
+  if (startup_id != nullptr) {
+    gtk_window_set_startup_id(window, startup_id);
+  }
+  // Not shown before the first frame, |kNotifyFirstFrameRasterizedMethodName| presents it (with the startup ID set above).
+  if (plugin->startup_profile[kStartupPhasePresented] > 0) {
+    gtk_window_present(window);
+  }
+}
+
+static gboolean send_single_instance_launches_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->launches_source_id = 0;
+  if (plugin->pending_present) {
+    present_single_instance_window(plugin);
+  }
+  g_autoptr(FlValue) result = event_metadata_to_value(plugin);
+  fl_value_set_string_take(result, "launches", plugin->pending_launches);
+  plugin->pending_launches = fl_value_new_list();
+  fl_method_channel_invoke_method(plugin->channel, kSingleInstanceDataReceivedMethodName, result, nullptr, nullptr, nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+// Queues |launch| (ownership is taken). All the launches received within |kSingleInstanceBatchInterval| are sent to Dart in a single
+// |kSingleInstanceDataReceivedMethodName| call, so that a burst of launches (e.g. opening hundreds of files) costs one dispatch.
+static void queue_single_instance_launch(WindowPlusPlugin* plugin, FlValue* launch) {
+  fl_value_append_take(plugin->pending_launches, launch);
+  if (plugin->launches_source_id == 0) {
+    plugin->launches_source_id = g_timeout_add(kSingleInstanceBatchInterval, send_single_instance_launches_cb, plugin);
+  }
+}
+
+typedef struct {
+  WindowPlusPlugin* plugin;
+  GSocketConnection* connection;
+  // Cancelled by the |kSingleInstanceConnectionTimeout| timeout.
+  GCancellable* cancellable;
+  guint timeout_source_id;
+  // Size prefix (little-endian) & the message.
+  guint32 size;
+  gpointer data;
+} SingleInstanceConnection;
+
+static void single_instance_connection_free(SingleInstanceConnection* context) {
+  if (context->timeout_source_id > 0) {
+    g_source_remove(context->timeout_source_id);
+  }
+  g_io_stream_close(G_IO_STREAM(context->connection), nullptr, nullptr);
+  g_object_unref(context->connection);
+  g_object_unref(context->cancellable);
+  g_object_unref(context->plugin);
+  g_free(context->data);
+  g_free(context);
+}
+
+static gboolean single_instance_timeout_cb(gpointer user_data) {
+  SingleInstanceConnection* context = static_cast<SingleInstanceConnection*>(user_data);
+  context->timeout_source_id = 0;
+  // The pending read completes with G_IO_ERROR_CANCELLED & releases the connection.
+  g_cancellable_cancel(context->cancellable);
+  return G_SOURCE_REMOVE;
+}
+
+static void single_instance_read_cb(GObject* source, GAsyncResult* result, gpointer user_data) {
+  SingleInstanceConnection* context = static_cast<SingleInstanceConnection*>(user_data);
+  gsize read = 0;
+  if (g_input_stream_read_all_finish(G_INPUT_STREAM(source), result, &read, nullptr) && read == context->size) {
+    g_autoptr(GBytes) bytes = g_bytes_new_take(g_steal_pointer(&context->data), context->size);
+    g_autoptr(GVariant) message = g_variant_ref_sink(g_variant_new_from_bytes(G_VARIANT_TYPE(kSingleInstanceMessageType), bytes, FALSE));
+    // Sent by another process, make sure it is well-formed before reading.
+    g_autoptr(GVariant) normal = g_variant_get_normal_form(message);
+    const gchar* working_directory = nullptr;
+    g_autofree const gchar** arguments = nullptr;
+    g_autoptr(GVariant) environment = nullptr;
+    g_variant_get(normal, "(&s^a&s@a{ss})", &working_directory, &arguments, &environment);
+    queue_single_instance_launch(context->plugin, single_instance_launch_to_value(working_directory, arguments, environment));
+    // Presented when the batch is delivered, with the startup hint of the latest launch.
+    const gchar* startup_id = nullptr;
+    if (g_variant_lookup(environment, "XDG_ACTIVATION_TOKEN", "&s", &startup_id) || g_variant_lookup(environment, "DESKTOP_STARTUP_ID", "&s", &startup_id)) {
+      g_free(context->plugin->pending_startup_id);
+      context->plugin->pending_startup_id = g_strdup(startup_id);
+    }
+    context->plugin->pending_present = TRUE;
+  }
+  single_instance_connection_free(context);
+}
+
+static void single_instance_read_size_cb(GObject* source, GAsyncResult* result, gpointer user_data) {
+  SingleInstanceConnection* context = static_cast<SingleInstanceConnection*>(user_data);
+  gsize read = 0;
+  if (!g_input_stream_read_all_finish(G_INPUT_STREAM(source), result, &read, nullptr) || read != sizeof(context->size)) {
+    single_instance_connection_free(context);
+    return;
+  }
+  context->size = GUINT32_FROM_LE(context->size);
+  if (context->size == 0 || context->size > kSingleInstanceMaximumMessageSize) {
+    g_warning("Ignoring single instance message of %u bytes.", context->size);
+    single_instance_connection_free(context);
+    return;
+  }
+  context->data = g_malloc(context->size);
+  g_input_stream_read_all_async(G_INPUT_STREAM(source), context->data, context->size, G_PRIORITY_DEFAULT, context->cancellable, single_instance_read_cb, context);
+}
+
+static gboolean single_instance_incoming_cb(GSocketService* service, GSocketConnection* connection, GObject* source, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  // Abstract sockets are not protected by file-system permissions, only accept the connections from the same user.
+  g_autoptr(GCredentials) credentials = g_socket_get_credentials(g_socket_connection_get_socket(connection), nullptr);
+  if (credentials == nullptr || g_credentials_get_unix_user(credentials, nullptr) != getuid()) {
+    return TRUE;
+  }
+  // The secondary instance writes a single size-prefixed message, see |window_plus_plugin_send_single_instance_arguments|.
+  SingleInstanceConnection* context = g_new0(SingleInstanceConnection, 1);
+  context->plugin = WINDOW_PLUS_PLUGIN(g_object_ref(plugin));
+  context->connection = G_SOCKET_CONNECTION(g_object_ref(connection));
+  context->cancellable = g_cancellable_new();
+  context->timeout_source_id = g_timeout_add(kSingleInstanceConnectionTimeout, single_instance_timeout_cb, context);
+  g_input_stream_read_all_async(g_io_stream_get_input_stream(G_IO_STREAM(connection)), &context->size, sizeof(context->size), G_PRIORITY_DEFAULT,
+                                context->cancellable, single_instance_read_size_cb, context);
+  return TRUE;
+}
+
+// Starts listening for the launches of secondary instances on a per-user & per-|application| abstract Unix socket. Does nothing if
+// already started or another primary instance is listening already. See |window_plus_plugin_send_single_instance_arguments|.
+static void start_single_instance_server(WindowPlusPlugin* plugin, const gchar* application) {
+  if (plugin->single_instance_service != nullptr) {
+    return;
+  }
+  g_autofree gchar* name = get_single_instance_socket_name(application);
+  g_autoptr(GSocketAddress) address = g_unix_socket_address_new_with_type(name, -1, G_UNIX_SOCKET_ADDRESS_ABSTRACT);
+  GSocketService* service = g_socket_service_new();
+  if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, nullptr, nullptr, nullptr)) {
+    g_object_unref(service);
+    return;
+  }
+  g_signal_connect(service, "incoming", G_CALLBACK(single_instance_incoming_cb), plugin);
+  g_socket_service_start(service);
+  plugin->single_instance_service = service;
+}
+
+static gboolean delete_event(GtkWidget* self, GdkEvent* event, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  g_autoptr(FlValue) arguments = event_metadata_to_value(plugin);
+  fl_method_channel_invoke_method(plugin->channel, kWindowCloseReceivedMethodName, arguments, NULL, NULL, NULL);
+  return TRUE;
+}
+
+// |timestamp| is the monotonic time at which the native event was received.
+static void send_event_record(WindowPlusPlugin* plugin, gint32 type, guint32 state, guint32 changed, gint64 timestamp, gint x, gint y, gint width, gint height,
+                              const GtkBorder* frame_extents = nullptr) {
+  WindowPlusEventRecord record;
+  record.type = GINT32_TO_LE(type);
+  record.state = GUINT32_TO_LE(state);
+  record.sequence = GINT64_TO_LE(++plugin->event_sequence);
+  record.timestamp = GINT64_TO_LE(timestamp);
+  record.x = GINT32_TO_LE(x);
+  record.y = GINT32_TO_LE(y);
+  record.width = GINT32_TO_LE(width);
+  record.height = GINT32_TO_LE(height);
+  record.changed = GUINT32_TO_LE(changed);
+  record.reserved = 0;
+  record.frame_left = GINT32_TO_LE(frame_extents != nullptr ? frame_extents->left : 0);
+  record.frame_top = GINT32_TO_LE(frame_extents != nullptr ? frame_extents->top : 0);
+  record.frame_right = GINT32_TO_LE(frame_extents != nullptr ? frame_extents->right : 0);
+  record.frame_bottom = GINT32_TO_LE(frame_extents != nullptr ? frame_extents->bottom : 0);
+  g_autoptr(FlValue) message = fl_value_new_uint8_list(reinterpret_cast<const uint8_t*>(&record), sizeof(WindowPlusEventRecord));
+  fl_basic_message_channel_send(plugin->event_channel, message, nullptr, nullptr, nullptr);
+}
+
+static void send_window_state_event(WindowPlusPlugin* plugin, GdkWindowState window_state) {
+  guint32 state = get_window_state_bits(plugin, window_state);
+  // Only send the bits which changed since the last record, every bit is sent with the first one. |changed_mask| is not used directly,
+  // since it also contains the bits which are not forwarded (e.g. GDK_WINDOW_STATE_*_TILED/RESIZABLE) & may be set without any change.
+  guint32 changed = plugin->last_sent_state < 0 ? kWindowStateAll : (state ^ static_cast<guint32>(plugin->last_sent_state));
+  if (changed == 0) {
+    return;
+  }
+  plugin->last_sent_state = state;
+  send_event_record(plugin, kWindowStateEventType, state, changed, g_get_monotonic_time(), -1, -1, -1, -1);
+}
+
+static gboolean window_state_event(GtkWidget* self, GdkEventWindowState* event, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  send_window_state_event(plugin, event->new_window_state);
+  return FALSE;
+}
+
+// Returns the client-side decoration drawn by GTK around the |gtk_window_get_size| area of |window| i.e. the shadow & the resize border.
+// Computed from the widget allocations, without any round trip to the display server.
+static GtkBorder get_frame_extents(GtkWindow* window, GtkWidget* view, gint width, gint height) {
+  GtkBorder extents = GtkBorder{0, 0, 0, 0};
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (gdk_window == nullptr || !gtk_style_context_has_class(gtk_widget_get_style_context(GTK_WIDGET(window)), "csd")) {
+    return extents;
+  }
+  // The title bar (if any) is a part of the |gtk_window_get_size| area, the shadow starts right above it.
+  gint x = 0, y = 0;
+  GtkWidget* titlebar = gtk_window_get_titlebar(window);
+  if (titlebar != nullptr && gtk_widget_get_visible(titlebar)) {
+    gtk_widget_translate_coordinates(titlebar, GTK_WIDGET(window), 0, 0, &x, &y);
+  } else {
+    gtk_widget_translate_coordinates(view, GTK_WIDGET(window), 0, 0, &x, &y);
+  }
+  extents.left = MAX(x, 0);
+  extents.top = MAX(y, 0);
+  extents.right = MAX(gdk_window_get_width(gdk_window) - extents.left - width, 0);
+  extents.bottom = MAX(gdk_window_get_height(gdk_window) - extents.top - height, 0);
+  return extents;
+}
+
+static void send_configure_event(WindowPlusPlugin* plugin) {
+  GtkWindow* window = get_window(plugin);
+
+  gint width = 0, height = 0;
+  gtk_window_get_size(window, &width, &height);
+  GtkBorder frame_extents = get_frame_extents(window, plugin->view, width, height);
+
+  // Same origin as |kGetPositionMethodName|, already queried once for this configure-event by |tracking_configure_event| (connected first).
+  send_event_record(plugin, kConfigureEventType, 0, 0, plugin->configure_event_time, plugin->snapshot.x, plugin->snapshot.y, width, height, &frame_extents);
+  plugin->last_configure_event_time = g_get_monotonic_time();
+}
+
+static gboolean configure_event_tick_cb(GtkWidget* self, GdkFrameClock* frame_clock, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->configure_event_tick_id = 0;
+  send_configure_event(plugin);
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean configure_event_timeout_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->configure_event_source_id = 0;
+  send_configure_event(plugin);
+  return G_SOURCE_REMOVE;
+}
+
+// Removes the pending (coalesced) configure-event, if any. Returns whether one was pending.
+static gboolean cancel_pending_configure_event(WindowPlusPlugin* plugin) {
+  gboolean pending = FALSE;
+  if (plugin->configure_event_tick_id > 0) {
+    // The tick callback is gone with the |window| already, if it is finalized.
+    if (plugin->window != nullptr) {
+      gtk_widget_remove_tick_callback(GTK_WIDGET(plugin->window), plugin->configure_event_tick_id);
+    }
+    plugin->configure_event_tick_id = 0;
+    pending = TRUE;
+  }
+  if (plugin->configure_event_source_id > 0) {
+    g_source_remove(plugin->configure_event_source_id);
+    plugin->configure_event_source_id = 0;
+    pending = TRUE;
+  }
+  return pending;
+}
+
+gboolean configure_event(GtkWidget* self, GdkEventConfigure* event, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->configure_event_time = g_get_monotonic_time();
+  // An event is already pending, it will send the latest geometry when flushed. Just count this one as dropped.
+  if (plugin->configure_event_tick_id > 0 || plugin->configure_event_source_id > 0) {
+    plugin->dropped_event_count++;
+    return FALSE;
+  }
+  switch (plugin->event_coalescing) {
+    case kEventCoalescingFrame: {
+      // Flush at most once per |GdkFrameClock| update. The frame clock does not tick while frozen by |begin_resize_sync|, send right away.
+      if (plugin->resize_sync_frozen) {
+        send_configure_event(plugin);
+      } else {
+        plugin->configure_event_tick_id = gtk_widget_add_tick_callback(self, configure_event_tick_cb, plugin, nullptr);
+      }
+      break;
+    }
+    case kEventCoalescingRate: {
+      // Flush at most |event_coalescing_rate| times per second.
+      gint64 interval = G_USEC_PER_SEC / plugin->event_coalescing_rate;
+      gint64 elapsed = g_get_monotonic_time() - plugin->last_configure_event_time;
+      if (elapsed >= interval) {
+        send_configure_event(plugin);
+      } else {
+        plugin->configure_event_source_id = g_timeout_add((interval - elapsed) / 1000 + 1, configure_event_timeout_cb, plugin);
+      }
+      break;
+    }
+    default: {
+      send_configure_event(plugin);
+      break;
+    }
+  }
+  return FALSE;
+}
+
+static void send_live_operation_event(WindowPlusPlugin* plugin, gint32 type) {
+  if (plugin->live_operation_event_subscriptions > 0) {
+    send_event_record(plugin, type, 0, 0, g_get_monotonic_time(), plugin->last_geometry.x, plugin->last_geometry.y, plugin->last_geometry.width,
+                      plugin->last_geometry.height);
+  }
+}
+
+static void end_live_operation(WindowPlusPlugin* plugin) {
+  if (plugin->live_operation_source_id > 0) {
+    g_source_remove(plugin->live_operation_source_id);
+    plugin->live_operation_source_id = 0;
+  }
+  if (plugin->live_operation == kLiveOperationResize) {
+    send_live_operation_event(plugin, kResizeEndedEventType);
+  } else if (plugin->live_operation == kLiveOperationMove) {
+    send_live_operation_event(plugin, kMoveEndedEventType);
+  }
+  plugin->live_operation = kLiveOperationNone;
+}
+
+// Whether a pointer button is held down i.e. a drag may still be in progress while the pointer rests. X11 only, where the button state is
+// queried from the server (also while the window manager grabs the pointer during the drag).
+static gboolean is_pointer_button_held(WindowPlusPlugin* plugin) {
+#ifdef GDK_WINDOWING_X11
+  GdkDisplay* display = gtk_widget_get_display(plugin->view);
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(get_window(plugin)));
+  if (GDK_IS_X11_DISPLAY(display) && gdk_window != nullptr) {
+    GdkDevice* pointer = gdk_seat_get_pointer(gdk_display_get_default_seat(display));
+    GdkModifierType mask = static_cast<GdkModifierType>(0);
+    gdk_window_get_device_position(gdk_window, pointer, nullptr, nullptr, &mask);
+    return (mask & (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK)) != 0;
+  }
+#endif
+  return FALSE;
+}
+
+static gboolean live_operation_timeout_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->live_operation_source_id = 0;
+  // The pointer rests mid-drag, the operation is not over yet.
+  if (is_pointer_button_held(plugin)) {
+    plugin->live_operation_source_id = g_timeout_add(kLiveOperationIdleInterval, live_operation_timeout_cb, plugin);
+    return G_SOURCE_REMOVE;
+  }
+  end_live_operation(plugin);
+  return G_SOURCE_REMOVE;
+}
+
+// Starts a live |operation| (if not already in progress) & (re-)starts its idle timeout. Called when a configure-event burst is detected
+// or right before |gtk_window_begin_move_drag| / |gtk_window_begin_resize_drag|, where the operation is known up-front.
+static void begin_live_operation(WindowPlusPlugin* plugin, gint operation) {
+  if (plugin->live_operation != operation) {
+    end_live_operation(plugin);
+    plugin->live_operation = operation;
+    send_live_operation_event(plugin, operation == kLiveOperationResize ? kResizeStartedEventType : kMoveStartedEventType);
+  }
+  if (plugin->live_operation_source_id > 0) {
+    g_source_remove(plugin->live_operation_source_id);
+  }
+  plugin->live_operation_source_id = g_timeout_add(kLiveOperationIdleInterval, live_operation_timeout_cb, plugin);
+}
+
+// Detects live operations from the configure-event(s). A single geometry change (e.g. |kResizeMethodName|) does not start one. The ones
+// started by the plugin (the custom frame & caption regions) are known up-front, see |caption_pressed_cb|.
+static void update_live_operation(WindowPlusPlugin* plugin, const GdkEventConfigure* event) {
+  GdkRectangle geometry = GdkRectangle{event->x, event->y, event->width, event->height};
+  gboolean resized = geometry.width != plugin->last_geometry.width || geometry.height != plugin->last_geometry.height;
+  gboolean moved = geometry.x != plugin->last_geometry.x || geometry.y != plugin->last_geometry.y;
+  if (!resized && !moved) {
+    return;
+  }
+  gint64 now = g_get_monotonic_time();
+  gboolean burst = now - plugin->last_geometry_time < kLiveOperationIdleInterval * 1000;
+  plugin->last_geometry = geometry;
+  plugin->last_geometry_time = now;
+  if (plugin->live_operation == kLiveOperationNone && now < plugin->live_operation_suppressed_until) {
+    // Extended by every configure-event meanwhile, e.g. a window manager animation may take longer than the interval.
+    plugin->live_operation_suppressed_until = now + kLiveOperationIdleInterval * 1000;
+    return;
+  }
+  if (plugin->live_operation != kLiveOperationNone) {
+    // A resize from the top or left edge also moves the window, keep it a resize.
+    begin_live_operation(plugin, resized ? kLiveOperationResize : plugin->live_operation);
+  } else if (burst) {
+    begin_live_operation(plugin, resized ? kLiveOperationResize : kLiveOperationMove);
+  }
+}
+
+// Returns whether the |FlView| coordinates |x|, |y| are within a caption region & not within any of the no-drag regions.
+static gboolean hit_test_caption_regions(WindowPlusPlugin* plugin, gint x, gint y) {
+  gboolean caption = FALSE;
+  for (guint i = 0; i < plugin->caption_regions->len; i++) {
+    const CaptionRegion* region = &g_array_index(plugin->caption_regions, CaptionRegion, i);
+    if (x >= region->rect.x && y >= region->rect.y && x < region->rect.x + region->rect.width && y < region->rect.y + region->rect.height) {
+      if (!region->drag) {
+        return FALSE;
+      }
+      caption = TRUE;
+    }
+  }
+  return caption;
+}
+
+// Returns the |kResizeEdge*| bits of the custom frame under the |window| coordinates |x|, |y|. 0 if not resizable from there.
+static gint get_resize_edges(WindowPlusPlugin* plugin, GtkWindow* window, gdouble x, gdouble y) {
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (!plugin->custom_frame || gdk_window == nullptr || !gtk_window_get_resizable(window) ||
+      (gdk_window_get_state(gdk_window) & (GDK_WINDOW_STATE_MAXIMIZED | GDK_WINDOW_STATE_FULLSCREEN | GDK_WINDOW_STATE_TILED))) {
+    return 0;
+  }
+  gint width = gtk_widget_get_allocated_width(GTK_WIDGET(window));
+  gint height = gtk_widget_get_allocated_height(GTK_WIDGET(window));
+  return kResizeEdgeLeft * (x < kResizeBorderSize) | kResizeEdgeRight * (x >= width - kResizeBorderSize) | kResizeEdgeTop * (y < kResizeBorderSize) |
+         kResizeEdgeBottom * (y >= height - kResizeBorderSize);
+}
+
+// Returns the |GdkWindowEdge| of the |edges| bits & the cursor shown above it.
+static GdkWindowEdge resize_edges_to_window_edge(gint edges, const gchar** cursor) {
+  switch (edges) {
+    case kResizeEdgeTop | kResizeEdgeLeft:
+      *cursor = "nw-resize";
+      return GDK_WINDOW_EDGE_NORTH_WEST;
+    case kResizeEdgeTop | kResizeEdgeRight:
+      *cursor = "ne-resize";
+      return GDK_WINDOW_EDGE_NORTH_EAST;
+    case kResizeEdgeBottom | kResizeEdgeLeft:
+      *cursor = "sw-resize";
+      return GDK_WINDOW_EDGE_SOUTH_WEST;
+    case kResizeEdgeBottom | kResizeEdgeRight:
+      *cursor = "se-resize";
+      return GDK_WINDOW_EDGE_SOUTH_EAST;
+    case kResizeEdgeTop:
+      *cursor = "n-resize";
+      return GDK_WINDOW_EDGE_NORTH;
+    case kResizeEdgeBottom:
+      *cursor = "s-resize";
+      return GDK_WINDOW_EDGE_SOUTH;
+    case kResizeEdgeLeft:
+      *cursor = "w-resize";
+      return GDK_WINDOW_EDGE_WEST;
+    default:
+      *cursor = "e-resize";
+      return GDK_WINDOW_EDGE_EAST;
+  }
+}
+
+// Shows the resize cursor while the pointer is above the edges of the custom frame. The cursor is set on the |FlView|'s |GdkWindow| (like
+// Flutter's own mouse cursors) & reset to the default one after leaving the edges.
+static void update_resize_cursor(WindowPlusPlugin* plugin, gint edges) {
+  if (edges == plugin->resize_edges) {
+    return;
+  }
+  plugin->resize_edges = edges;
+  GdkWindow* gdk_window = gtk_widget_get_window(plugin->view);
+  if (gdk_window == nullptr) {
+    return;
+  }
+  if (edges == 0) {
+    gdk_window_set_cursor(gdk_window, nullptr);
+    return;
+  }
+  const gchar* name = nullptr;
+  resize_edges_to_window_edge(edges, &name);
+  g_autoptr(GdkCursor) cursor = gdk_cursor_new_from_name(gdk_window_get_display(gdk_window), name);
+  gdk_window_set_cursor(gdk_window, cursor);
+}
+
+static void frame_motion_cb(GtkEventControllerMotion* controller, gdouble x, gdouble y, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  update_resize_cursor(plugin, get_resize_edges(plugin, get_window(plugin), x, y));
+}
 
-// Common:
+static void frame_leave_cb(GtkEventControllerMotion* controller, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  update_resize_cursor(plugin, 0);
+}
 
-static constexpr auto kEnsureInitializedMethodName = "ensureInitialized";
-static constexpr auto kGetMinimumSizeMethodName = "getMinimumSize";
-static constexpr auto kSetMinimumSizeMethodName = "setMinimumSize";
-static constexpr auto kWindowCloseReceivedMethodName = "windowCloseReceived";
-static constexpr auto kNotifyFirstFrameRasterizedMethodName = "notifyFirstFrameRasterized";
-static constexpr auto kSingleInstanceDataReceivedMethodName = "singleInstanceDataReceived";
-static constexpr auto kGetStateMethodName = "getState";
-static constexpr auto kCloseMethodName = "close";
-static constexpr auto kDestroyMethodName = "destroy";
-static constexpr auto kGetIsMinimizedMethodName = "getMinimized";
-static constexpr auto kGetIsMaximizedMethodName = "getMaximized";
-static constexpr auto kGetIsFullscreenMethodName = "getIsFullscreen";
-static constexpr auto kGetSizeMethodName = "getSize";
-static constexpr auto kGetPositionMethodName = "getPosition";
-static constexpr auto kGetMonitorsMethodName = "getMonitors";
-static constexpr auto kSetIsFullscreenMethodName = "setIsFullscreen";
-static constexpr auto kMaximizeMethodName = "maximize";
-static constexpr auto kRestoreMethodName = "restore";
-static constexpr auto kMinimizeMethodName = "minimize";
-static constexpr auto kMoveMethodName = "move";
-static constexpr auto kResizeMethodName = "resize";
-static constexpr auto kHideMethodName = "hide";
-static constexpr auto kShowMethodName = "show";
+// Starts resizing the |window| on a primary button press at the edges of the custom frame, moving it on a press within the caption regions
+// & maximizes or restores it on a double-click within the caption regions. All of it right away, before the event reaches the |FlView| i.e.
+// without waiting for the pan slop or any round trip to Dart.
+static void caption_pressed_cb(GtkGestureMultiPress* gesture, gint n_press, gdouble x, gdouble y, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  GtkWindow* window = get_window(plugin);
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (gdk_window == nullptr) {
+    return;
+  }
+  gint edges = get_resize_edges(plugin, window, x, y);
+  gint view_x = 0, view_y = 0;
+  if (edges == 0 && (!gtk_widget_translate_coordinates(GTK_WIDGET(window), plugin->view, x, y, &view_x, &view_y) || !hit_test_caption_regions(plugin, view_x, view_y))) {
+    return;
+  }
+  GdkWindowState state = gdk_window_get_state(gdk_window);
+  if (state & GDK_WINDOW_STATE_FULLSCREEN) {
+    return;
+  }
+  const GdkEvent* event = gtk_gesture_get_last_event(GTK_GESTURE(gesture), gtk_gesture_single_get_current_sequence(GTK_GESTURE_SINGLE(gesture)));
+  if (event == nullptr) {
+    return;
+  }
+  // The |FlView| does not receive the presses handled here.
+  gtk_gesture_set_state(GTK_GESTURE(gesture), GTK_EVENT_SEQUENCE_CLAIMED);
+  if (edges != 0) {
+    const gchar* cursor = nullptr;
+    gdouble root_x = 0.0, root_y = 0.0;
+    gdk_event_get_root_coords(event, &root_x, &root_y);
+    begin_live_operation(plugin, kLiveOperationResize);
+    gtk_window_begin_resize_drag(window, resize_edges_to_window_edge(edges, &cursor), GDK_BUTTON_PRIMARY, static_cast<gint>(root_x), static_cast<gint>(root_y),
+                                 gdk_event_get_time(event));
+    gtk_event_controller_reset(GTK_EVENT_CONTROLLER(gesture));
+    return;
+  }
+  // |n_press| is not reliable here, the window manager grabs the pointer (& receives the release) once the move starts.
+  guint32 time = gdk_event_get_time(event);
+  gint double_click_time = 400;
+  g_object_get(gtk_widget_get_settings(GTK_WIDGET(window)), "gtk-double-click-time", &double_click_time, nullptr);
+  if (plugin->last_caption_press_time != 0 && time - plugin->last_caption_press_time <= static_cast<guint32>(double_click_time)) {
+    plugin->last_caption_press_time = 0;
+    suppress_live_operation_detection(plugin);
+    if (state & GDK_WINDOW_STATE_MAXIMIZED) {
+      gtk_window_unmaximize(window);
+    } else {
+      gtk_window_maximize(window);
+    }
+  } else {
+    plugin->last_caption_press_time = time;
+    gdouble root_x = 0.0, root_y = 0.0;
+    gdk_event_get_root_coords(event, &root_x, &root_y);
+    begin_live_operation(plugin, kLiveOperationMove);
+    gtk_window_begin_move_drag(window, GDK_BUTTON_PRIMARY, static_cast<gint>(root_x), static_cast<gint>(root_y), time);
+  }
+  gtk_event_controller_reset(GTK_EVENT_CONTROLLER(gesture));
+}
 
-// GTK Exclusives:
+// Creates the capture-phase gesture handling the presses within the caption regions & the custom frame edges, see |caption_pressed_cb|.
+static void ensure_caption_gesture(WindowPlusPlugin* plugin, GtkWindow* window) {
+  if (plugin->caption_gesture != nullptr) {
+    return;
+  }
+  plugin->caption_gesture = gtk_gesture_multi_press_new(GTK_WIDGET(window));
+  gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(plugin->caption_gesture), GDK_BUTTON_PRIMARY);
+  gtk_event_controller_set_propagation_phase(GTK_EVENT_CONTROLLER(plugin->caption_gesture), GTK_PHASE_CAPTURE);
+  g_signal_connect(plugin->caption_gesture, "pressed", G_CALLBACK(caption_pressed_cb), plugin);
+}
 
-static constexpr auto kWindowStateEventReceivedMethodName = "windowStateEventReceived";
-static constexpr auto kConfigureEventReceivedMethodName = "configureEventReceived";
+// Adds or replaces the regions in |regions| & removes the IDs in |removed|, both |FL_VALUE_TYPE_INT32_LIST| (or null). Only the changed
+// regions are sent from Dart. The gesture is created with the first region.
+static void update_caption_regions(WindowPlusPlugin* plugin, FlValue* regions, FlValue* removed) {
+  if (removed != nullptr && fl_value_get_type(removed) == FL_VALUE_TYPE_INT32_LIST) {
+    const int32_t* ids = fl_value_get_int32_list(removed);
+    for (size_t i = 0; i < fl_value_get_length(removed); i++) {
+      for (guint j = 0; j < plugin->caption_regions->len; j++) {
+        if (g_array_index(plugin->caption_regions, CaptionRegion, j).id == ids[i]) {
+          g_array_remove_index_fast(plugin->caption_regions, j);
+          break;
+        }
+      }
+    }
+  }
+  if (regions != nullptr && fl_value_get_type(regions) == FL_VALUE_TYPE_INT32_LIST) {
+    const int32_t* values = fl_value_get_int32_list(regions);
+    for (size_t i = 0; i + kCaptionRegionFieldCount <= fl_value_get_length(regions); i += kCaptionRegionFieldCount) {
+      CaptionRegion region = CaptionRegion{values[i], values[i + 1] != 0, GdkRectangle{values[i + 2], values[i + 3], values[i + 4], values[i + 5]}};
+      guint j = 0;
+      for (; j < plugin->caption_regions->len; j++) {
+        if (g_array_index(plugin->caption_regions, CaptionRegion, j).id == region.id) {
+          g_array_index(plugin->caption_regions, CaptionRegion, j) = region;
+          break;
+        }
+      }
+      if (j == plugin->caption_regions->len) {
+        g_array_append_val(plugin->caption_regions, region);
+      }
+    }
+  }
+  GtkWindow* window = get_window(plugin);
+  if (plugin->caption_regions->len > 0 && window != nullptr) {
+    ensure_caption_gesture(plugin, window);
+  }
+}
 
-// TODO (alexmercerind): Expose in public API.
+// Makes the |window| undecorated & handles the resize edges natively, see |get_resize_edges|. The caption is drawn by Dart.
+static void enable_custom_frame(WindowPlusPlugin* plugin, GtkWindow* window) {
+  if (plugin->custom_frame) {
+    return;
+  }
+  plugin->custom_frame = TRUE;
+  gtk_window_set_decorated(window, FALSE);
+  ensure_caption_gesture(plugin, window);
+  plugin->frame_motion_controller = gtk_event_controller_motion_new(GTK_WIDGET(window));
+  gtk_event_controller_set_propagation_phase(plugin->frame_motion_controller, GTK_PHASE_CAPTURE);
+  g_signal_connect(plugin->frame_motion_controller, "motion", G_CALLBACK(frame_motion_cb), plugin);
+  g_signal_connect(plugin->frame_motion_controller, "leave", G_CALLBACK(frame_leave_cb), plugin);
+}
 
-static constexpr auto kMonitorSafeArea = 8;
-static constexpr auto kWindowDefaultWidth = 1280;
-static constexpr auto kWindowDefaultHeight = 720;
+// Returns the refresh interval (in microseconds) of the window's monitor, 0 if not known.
+static gint64 get_monitor_refresh_interval(WindowPlusPlugin* plugin) {
+  gint monitor = plugin->snapshot.monitor;
+  if (monitor < 0 || static_cast<guint>(monitor) >= plugin->monitors->len) {
+    return 0;
+  }
+  gint refresh_rate = g_array_index(plugin->monitors, MonitorInfo, monitor).refresh_rate;
+  return refresh_rate > 0 ? G_GINT64_CONSTANT(1000000000) / refresh_rate : 0;
+}
 
-#define WINDOW_PLUS_PLUGIN(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), window_plus_plugin_get_type(), WindowPlusPlugin))
+// Thaws the toplevel |GdkWindow| frozen by |begin_resize_sync|, letting GTK paint & acknowledge the configure to the window manager.
+static void end_resize_sync(WindowPlusPlugin* plugin) {
+  if (plugin->resize_sync_source_id > 0) {
+    g_source_remove(plugin->resize_sync_source_id);
+    plugin->resize_sync_source_id = 0;
+  }
+  if (plugin->resize_sync_frozen) {
+    plugin->resize_sync_frozen = FALSE;
+    GdkWindow* gdk_window = plugin->window != nullptr ? gtk_widget_get_window(GTK_WIDGET(plugin->window)) : nullptr;
+    if (gdk_window != nullptr) {
+      G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+      gdk_window_thaw_toplevel_updates_libgtk_only(gdk_window);
+      G_GNUC_END_IGNORE_DEPRECATIONS
+    }
+  }
+}
 
-struct _WindowPlusPlugin {
-  GObject parent_instance;
-  FlPluginRegistrar* registrar;
-  FlMethodChannel* channel;
-};
+// Fallback if Flutter does not build a frame at the new size in time. Counted as a mismatched frame, the window manager shows the new size
+// first.
+static gboolean resize_sync_timeout_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->resize_sync_source_id = 0;
+  plugin->mismatched_resize_frame_count++;
+  end_resize_sync(plugin);
+  return G_SOURCE_REMOVE;
+}
 
-G_DEFINE_TYPE(WindowPlusPlugin, window_plus_plugin, g_object_get_type())
+// The frame at the new size was built a refresh interval ago & is normally rasterized by now. Dart only learns about the rasterization
+// from the engine's batched |FrameTiming|s (up to a second later), so the window is thawed now & |notify_frame_rasterized| checks the
+// reported |rasterFinish| against this thaw afterwards.
+static gboolean resize_sync_grace_cb(gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  plugin->resize_sync_source_id = 0;
+  plugin->resize_sync_thaw_time = g_get_monotonic_time();
+  plugin->resize_sync_thawed_width = plugin->resize_sync_width;
+  plugin->resize_sync_thawed_height = plugin->resize_sync_height;
+  end_resize_sync(plugin);
+  return G_SOURCE_REMOVE;
+}
 
-WindowPlusPlugin* plugin = nullptr;
+// Keeps the toplevel |GdkWindow| frozen after the |FlView| is allocated a new size (i.e. after GTK's layout for the latest configure-event),
+// until Dart reports a frame at that size through |kNotifyFrameBuiltMethodName| (& it is rasterized) or |kNotifyFrameRasterizedMethodName|.
+// GTK only updates the _NET_WM_SYNC_REQUEST counter after painting, so the window manager does not show the new frame size before Flutter
+// has rendered at it. Freezing also stops the |GdkFrameClock| i.e. no tick callbacks & no after-paint (nothing is painted) meanwhile.
+// Needed because the |FlView| of older Flutter versions does not hold GTK's paint until the engine rendered at its new allocation: GTK paints
+// & acknowledges the configure right away & the window manager shows the new frame size around the previous (stretched or cut) frame.
+static void begin_resize_sync(WindowPlusPlugin* plugin, gint width, gint height) {
+  plugin->resize_sync_width = width;
+  plugin->resize_sync_height = height;
+  if (!plugin->resize_sync_frozen) {
+    GtkWindow* window = get_window(plugin);
+    GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+    if (gdk_window == nullptr) {
+      return;
+    }
+    // A configure-event waiting for the next frame clock tick (|kEventCoalescingFrame|) would be stuck until the thaw, send it now.
+    if (plugin->configure_event_tick_id > 0) {
+      cancel_pending_configure_event(plugin);
+      send_configure_event(plugin);
+    }
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+    gdk_window_freeze_toplevel_updates_libgtk_only(gdk_window);
+    G_GNUC_END_IGNORE_DEPRECATIONS
+    plugin->resize_sync_frozen = TRUE;
+  }
+  if (plugin->resize_sync_source_id > 0) {
+    g_source_remove(plugin->resize_sync_source_id);
+  }
+  plugin->resize_sync_source_id = g_timeout_add(kResizeSyncTimeout, resize_sync_timeout_cb, plugin);
+}
 
-static GdkPoint get_cursor_position() {
-  GdkDisplay* display = gdk_display_get_default();
-  GdkSeat* seat = gdk_display_get_default_seat(display);
-  GdkDevice* device = gdk_seat_get_pointer(seat);
-  GdkPoint position = GdkPoint{0, 0};
-  gdk_device_get_position(device, NULL, &position.x, &position.y);
-  return position;
+static void view_size_allocate_cb(GtkWidget* widget, GdkRectangle* allocation, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  gint scale_factor = gtk_widget_get_scale_factor(widget);
+  gint width = allocation->width * scale_factor, height = allocation->height * scale_factor;
+  // Nothing is shown before the first frame & Flutter already rendered at this size.
+  if (plugin->startup_profile[kStartupPhasePresented] == 0 || (width == plugin->frame_width && height == plugin->frame_height)) {
+    return;
+  }
+  begin_resize_sync(plugin, width, height);
 }
 
-static gint get_default_window_width() {
-  GdkPoint cursor = get_cursor_position();
-  GdkDisplay* display = gdk_display_get_default();
-  GdkMonitor* monitor = gdk_display_get_monitor_at_point(display, cursor.x, cursor.y);
-  GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-  gdk_monitor_get_workarea(monitor, &workarea);
-  gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-  if (success) {
-    gint monitor_width = workarea.width - 96;
-    if (kWindowDefaultWidth > monitor_width) {
-      return monitor_width;
+// Called when Dart has built (laid out & painted, not yet rasterized) a frame at a new |width| x |height| (physical pixels). The window
+// is thawed after a refresh interval for the raster thread, unless the rasterization is reported first.
+static void notify_frame_built(WindowPlusPlugin* plugin, gint width, gint height) {
+  plugin->frame_width = width;
+  plugin->frame_height = height;
+  if (plugin->resize_sync_frozen && width == plugin->resize_sync_width && height == plugin->resize_sync_height) {
+    gint64 refresh_interval = get_monitor_refresh_interval(plugin);
+    if (refresh_interval <= 0) {
+      refresh_interval = kDefaultRefreshInterval;
     }
+    if (plugin->resize_sync_source_id > 0) {
+      g_source_remove(plugin->resize_sync_source_id);
+    }
+    plugin->resize_sync_source_id = g_timeout_add(MAX(refresh_interval / 1000, 1), resize_sync_grace_cb, plugin);
   }
-  return kWindowDefaultWidth;
 }
 
-static gint get_default_window_height() {
-  GdkPoint cursor = get_cursor_position();
-  GdkDisplay* display = gdk_display_get_default();
-  GdkMonitor* monitor = gdk_display_get_monitor_at_point(display, cursor.x, cursor.y);
-  GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-  gdk_monitor_get_workarea(monitor, &workarea);
-  gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-  if (success) {
-    gint monitor_height = workarea.height - 96;
-    if (kWindowDefaultHeight > monitor_height) {
-      return monitor_height;
+// Called when the engine reports the frame at a new |width| x |height| (physical pixels) rasterized at |raster_finish| (monotonic time in
+// microseconds i.e. same clock as |g_get_monotonic_time|, 0 if not known). Thaws right away if still frozen for it. If |resize_sync_grace_cb|
+// already thawed the window for it before the rasterization finished, the window manager showed the new size with an old frame: counted as
+// a mismatched frame.
+static void notify_frame_rasterized(WindowPlusPlugin* plugin, gint width, gint height, gint64 raster_finish) {
+  plugin->frame_width = width;
+  plugin->frame_height = height;
+  if (plugin->resize_sync_frozen && width == plugin->resize_sync_width && height == plugin->resize_sync_height) {
+    end_resize_sync(plugin);
+    return;
+  }
+  if (plugin->resize_sync_thaw_time > 0 && width == plugin->resize_sync_thawed_width && height == plugin->resize_sync_thawed_height) {
+    if (raster_finish > plugin->resize_sync_thaw_time) {
+      plugin->mismatched_resize_frame_count++;
     }
+    plugin->resize_sync_thaw_time = 0;
   }
-  return kWindowDefaultHeight;
 }
 
-static gboolean delete_event(GtkWidget* self, GdkEvent* event, gpointer user_data) {
-  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
-  g_autoptr(FlValue) arguments = fl_value_new_null();
-  fl_method_channel_invoke_method(plugin->channel, kWindowCloseReceivedMethodName, arguments, NULL, NULL, NULL);
-  return TRUE;
+// Enables resize synchronization, only on X11 i.e. with _NET_WM_SYNC_REQUEST. Wayland compositors already wait for the committed buffer.
+static void enable_resize_sync(WindowPlusPlugin* plugin) {
+#ifdef GDK_WINDOWING_X11
+  if (!plugin->resize_sync_enabled && GDK_IS_X11_DISPLAY(gtk_widget_get_display(plugin->view))) {
+    plugin->resize_sync_enabled = TRUE;
+    g_signal_connect_after(plugin->view, "size-allocate", G_CALLBACK(view_size_allocate_cb), plugin);
+  }
+#endif
 }
 
-static gboolean window_state_event(GtkWidget* self, GdkEventWindowState* event, gpointer user_data) {
+// If |pause_when_occluded|, tells Flutter to stop scheduling frames while the window is fully covered by other windows (the same as an
+// |AppLifecycleState.hidden| application) & to resume once it is exposed again. Only this transition is sent: the engine already sends its own
+// lifecycle states for the minimized & withdrawn window & for focus changes (from the window-state-event), which are left to it. Nothing is
+// sent before the first frame presents the |FlView| (pausing would keep the first frame from ever being rendered), also while the snapshot
+// of the last session is shown.
+static void update_occlusion(WindowPlusPlugin* plugin, GdkWindowState window_state) {
+  if (!plugin->pause_when_occluded || plugin->startup_profile[kStartupPhasePresented] == 0) {
+    return;
+  }
+  // The engine has sent |AppLifecycleState.hidden| itself & sends the next state once the window is shown again.
+  if (window_state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)) {
+    plugin->occluded = FALSE;
+    return;
+  }
+  if (plugin->obscured == plugin->occluded) {
+    return;
+  }
+  plugin->occluded = plugin->obscured;
+  const gchar* state = plugin->occluded ? "AppLifecycleState.hidden" : (window_state & GDK_WINDOW_STATE_FOCUSED) ? "AppLifecycleState.resumed" : "AppLifecycleState.inactive";
+  g_autoptr(FlValue) message = fl_value_new_string(state);
+  fl_basic_message_channel_send(plugin->lifecycle_channel, message, nullptr, nullptr, nullptr);
+}
+
+// Only delivered on X11 & without a compositing window manager, which never reports the window as covered.
+static gboolean visibility_notify_event(GtkWidget* self, GdkEventVisibility* event, gpointer user_data) {
   WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
-  gboolean minimized = event->new_window_state & GDK_WINDOW_STATE_ICONIFIED, maximized = event->new_window_state & GDK_WINDOW_STATE_MAXIMIZED,
-           fullscreen = event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN;
-  g_autoptr(FlValue) arguments = fl_value_new_map();
-  fl_value_set_string_take(arguments, "minimized", fl_value_new_bool(minimized));
-  fl_value_set_string_take(arguments, "maximized", fl_value_new_bool(maximized));
-  fl_value_set_string_take(arguments, "fullscreen", fl_value_new_bool(fullscreen));
-  fl_method_channel_invoke_method(plugin->channel, kWindowStateEventReceivedMethodName, arguments, NULL, NULL, NULL);
+  gboolean obscured = event->state == GDK_VISIBILITY_FULLY_OBSCURED;
+  if (obscured == plugin->obscured) {
+    return FALSE;
+  }
+  plugin->obscured = obscured;
+  GdkWindowState window_state = gdk_window_get_state(event->window);
+  update_state_snapshot(plugin);
+  update_occlusion(plugin, window_state);
+  if (plugin->window_state_event_subscriptions > 0) {
+    send_window_state_event(plugin, window_state);
+  }
   return FALSE;
 }
 
-gboolean configure_event(GtkWidget* self, GdkEventConfigure* event, gpointer user_data) {
-  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
-  GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(plugin->registrar));
-  GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+// |refresh_interval| (in microseconds) falls back to the refresh rate of the window's monitor, if the |GdkFrameClock| does not know it.
+static void send_frame_timing_event(WindowPlusPlugin* plugin, gint64 presentation_time, gint64 refresh_interval) {
+  gint monitor = plugin->snapshot.monitor;
+  if (refresh_interval <= 0) {
+    refresh_interval = get_monitor_refresh_interval(plugin);
+  }
+  guint32 changed = monitor != plugin->frame_timing_monitor ? 1 : 0;
+  plugin->frame_timing_monitor = monitor;
+  send_event_record(plugin, kFrameTimingEventType, 0, changed, presentation_time, monitor, -1, static_cast<gint>(refresh_interval), -1);
+}
 
-  gint width = 0, height = 0;
-  gtk_window_get_size(window, &width, &height);
+static void frame_clock_after_paint_cb(GdkFrameClock* frame_clock, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  gint64 refresh_interval = 0, presentation_time = 0;
+  gdk_frame_clock_get_refresh_info(frame_clock, gdk_frame_clock_get_frame_time(frame_clock), &refresh_interval, &presentation_time);
+  // The presentation time of the current frame is not known yet, the previous one is usually complete.
+  gint64 counter = gdk_frame_clock_get_frame_counter(frame_clock);
+  GdkFrameTimings* timings = counter > gdk_frame_clock_get_history_start(frame_clock) ? gdk_frame_clock_get_timings(frame_clock, counter - 1) : nullptr;
+  if (timings != nullptr && gdk_frame_timings_get_complete(timings) && gdk_frame_timings_get_presentation_time(timings) > 0) {
+    presentation_time = gdk_frame_timings_get_presentation_time(timings);
+    refresh_interval = gdk_frame_timings_get_refresh_interval(timings);
+  }
+  send_frame_timing_event(plugin, presentation_time, refresh_interval);
+}
 
-  g_autoptr(FlValue) arguments = fl_value_new_map();
+static gboolean tracking_window_state_event(GtkWidget* self, GdkEventWindowState* event, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  if (event->changed_mask & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_MAXIMIZED | GDK_WINDOW_STATE_FULLSCREEN | GDK_WINDOW_STATE_TILED | GDK_WINDOW_STATE_WITHDRAWN)) {
+    suppress_live_operation_detection(plugin);
+  }
+  update_state_snapshot(plugin);
+  schedule_save_window_state(plugin);
+  return FALSE;
+}
 
-  FlValue* position = fl_value_new_map();
-  fl_value_set_string_take(position, "x", fl_value_new_int(-1));
-  fl_value_set_string_take(position, "y", fl_value_new_int(-1));
-  fl_value_set_string_take(arguments, "position", position);
+static gboolean tracking_configure_event(GtkWidget* self, GdkEventConfigure* event, gpointer user_data) {
+  WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
+  update_state_snapshot(plugin);
+  update_live_operation(plugin, event);
+  schedule_save_window_state(plugin);
+  // Moved to another monitor, the window is not necessarily painted.
+  if (plugin->frame_timing_event_subscriptions > 0 && plugin->snapshot.monitor != plugin->frame_timing_monitor) {
+    send_frame_timing_event(plugin, g_get_monotonic_time(), 0);
+  }
+  return FALSE;
+}
 
-  FlValue* size = fl_value_new_map();
-  fl_value_set_string_take(size, "left", fl_value_new_int(0));
-  fl_value_set_string_take(size, "top", fl_value_new_int(0));
-  fl_value_set_string_take(size, "width", fl_value_new_int(width));
-  fl_value_set_string_take(size, "height", fl_value_new_int(height));
-  fl_value_set_string_take(arguments, "size", size);
+// Connects the signal handler sending |type| events to Dart, when the first Dart stream starts listening to it.
+static void subscribe_events(WindowPlusPlugin* plugin, gint64 type) {
+  GtkWidget* window = GTK_WIDGET(get_window(plugin));
+  switch (type) {
+    case kWindowStateEventType: {
+      if (plugin->window_state_event_subscriptions++ == 0) {
+        // Send every bit with the first record after (re-)subscribing.
+        plugin->last_sent_state = -1;
+        plugin->window_state_event_handler_id = g_signal_connect(window, "window-state-event", G_CALLBACK(window_state_event), plugin);
+      }
+      break;
+    }
+    case kConfigureEventType: {
+      if (plugin->configure_event_subscriptions++ == 0) {
+        plugin->configure_event_handler_id = g_signal_connect(window, "configure-event", G_CALLBACK(configure_event), plugin);
+      }
+      break;
+    }
+    case kResizeStartedEventType:
+    case kMoveStartedEventType: {
+      // Detected from |tracking_configure_event|, which is always connected. Only sent while subscribed.
+      plugin->live_operation_event_subscriptions++;
+      break;
+    }
+    case kFrameTimingEventType: {
+      if (plugin->frame_timing_event_subscriptions++ == 0) {
+        plugin->frame_timing_monitor = -1;
+        GdkFrameClock* frame_clock = gtk_widget_get_frame_clock(window);
+        if (frame_clock != nullptr) {
+          plugin->frame_clock = GDK_FRAME_CLOCK(g_object_ref(frame_clock));
+          plugin->frame_clock_handler_id = g_signal_connect(frame_clock, "after-paint", G_CALLBACK(frame_clock_after_paint_cb), plugin);
+        }
+        // Current monitor & refresh interval right away, the window may not be painted for a while.
+        send_frame_timing_event(plugin, g_get_monotonic_time(), 0);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
 
-  fl_method_channel_invoke_method(plugin->channel, kConfigureEventReceivedMethodName, arguments, NULL, NULL, NULL);
-  return FALSE;
+// Disconnects the signal handler sending |type| events to Dart, when the last Dart stream stops listening to it.
+static void unsubscribe_events(WindowPlusPlugin* plugin, gint64 type) {
+  GtkWidget* window = GTK_WIDGET(get_window(plugin));
+  switch (type) {
+    case kWindowStateEventType: {
+      if (plugin->window_state_event_subscriptions > 0 && --plugin->window_state_event_subscriptions == 0) {
+        g_signal_handler_disconnect(window, plugin->window_state_event_handler_id);
+        plugin->window_state_event_handler_id = 0;
+      }
+      break;
+    }
+    case kConfigureEventType: {
+      if (plugin->configure_event_subscriptions > 0 && --plugin->configure_event_subscriptions == 0) {
+        g_signal_handler_disconnect(window, plugin->configure_event_handler_id);
+        plugin->configure_event_handler_id = 0;
+        // Drop the pending (coalesced) configure-event, nobody is listening anymore.
+        cancel_pending_configure_event(plugin);
+      }
+      break;
+    }
+    case kResizeStartedEventType:
+    case kMoveStartedEventType: {
+      if (plugin->live_operation_event_subscriptions > 0) {
+        plugin->live_operation_event_subscriptions--;
+      }
+      break;
+    }
+    case kFrameTimingEventType: {
+      if (plugin->frame_timing_event_subscriptions > 0 && --plugin->frame_timing_event_subscriptions == 0 && plugin->frame_clock != nullptr) {
+        g_signal_handler_disconnect(plugin->frame_clock, plugin->frame_clock_handler_id);
+        plugin->frame_clock_handler_id = 0;
+        g_clear_object(&plugin->frame_clock);
+      }
+      break;
+    }
+    default:
+      break;
+  }
 }
 
 static void window_plus_plugin_handle_method_call(WindowPlusPlugin* self, FlMethodCall* method_call) {
   g_autoptr(FlMethodResponse) response = nullptr;
   const gchar* method = fl_method_call_get_name(method_call);
   if (strcmp(method, kEnsureInitializedMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
-
-    // Disconnect all delete-event handlers first in flutter 3.10.1, which causes delete_event not working.
-    // Issues from flutter/engine: https://github.com/flutter/engine/pull/40033
-    guint handler_id = g_signal_handler_find(window, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, view);
+    record_startup_phase(self, kStartupPhaseEnsureInitialized);
+    GtkWidget* view = self->view;
+    GtkWindow* window = get_window(self);
 
     FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* event_coalescing = fl_value_lookup_string(arguments, "eventCoalescing");
+    if (event_coalescing != nullptr && fl_value_get_type(event_coalescing) == FL_VALUE_TYPE_INT) {
+      // A configure-event pending under the previous policy (e.g. before a hot restart) is sent right away, its tick callback or timeout
+      // would not match the new policy.
+      if (fl_value_get_int(event_coalescing) != self->event_coalescing && cancel_pending_configure_event(self)) {
+        send_configure_event(self);
+      }
+      self->event_coalescing = fl_value_get_int(event_coalescing);
+    }
+    FlValue* event_coalescing_rate = fl_value_lookup_string(arguments, "eventCoalescingRate");
+    if (event_coalescing_rate != nullptr && fl_value_get_type(event_coalescing_rate) == FL_VALUE_TYPE_INT && fl_value_get_int(event_coalescing_rate) > 0) {
+      self->event_coalescing_rate = fl_value_get_int(event_coalescing_rate);
+    }
+    // Resize edges are handled natively, the caption is drawn by Dart.
+    FlValue* custom_frame = fl_value_lookup_string(arguments, "enableCustomFrame");
+    if (custom_frame != nullptr && fl_value_get_type(custom_frame) == FL_VALUE_TYPE_BOOL && fl_value_get_bool(custom_frame)) {
+      enable_custom_frame(self, window);
+    }
+
+    enable_resize_sync(self);
+
+    FlValue* pause_when_occluded = fl_value_lookup_string(arguments, "pauseWhenOccluded");
+    if (pause_when_occluded != nullptr && fl_value_get_type(pause_when_occluded) == FL_VALUE_TYPE_BOOL) {
+      self->pause_when_occluded = fl_value_get_bool(pause_when_occluded);
+    }
+
+    // The signal handlers sending events to Dart are connected lazily, see |kSubscribeEventsMethodName|.
     FlValue* enable_event_streams = fl_value_lookup_string(arguments, "enableEventStreams");
-    if (fl_value_get_type(enable_event_streams) == FL_VALUE_TYPE_BOOL) {
-      if (fl_value_get_bool(enable_event_streams)) {
-        g_signal_connect(window, "window-state-event", G_CALLBACK(window_state_event), self);
-        g_signal_connect(window, "configure-event", G_CALLBACK(configure_event), self);
+    if (enable_event_streams != nullptr && fl_value_get_type(enable_event_streams) == FL_VALUE_TYPE_BOOL) {
+      self->enable_event_streams = fl_value_get_bool(enable_event_streams);
+    }
+
+    // Called again on every hot restart, the options above are updated but the signal handlers are only connected once.
+    if (!self->initialized) {
+      self->initialized = TRUE;
+      // Always keep the state snapshot up to date, regardless of |enableEventStreams|. This does not involve the Dart side.
+      g_signal_connect(window, "window-state-event", G_CALLBACK(tracking_window_state_event), self);
+      g_signal_connect(window, "configure-event", G_CALLBACK(tracking_configure_event), self);
+
+      gtk_widget_add_events(GTK_WIDGET(window), GDK_VISIBILITY_NOTIFY_MASK);
+      g_signal_connect(window, "visibility-notify-event", G_CALLBACK(visibility_notify_event), self);
+
+      // Disconnect all delete-event handlers first in flutter 3.10.1, which causes delete_event not working.
+      // Issues from flutter/engine: https://github.com/flutter/engine/pull/40033
+      guint handler_id = g_signal_handler_find(window, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, view);
+      if (handler_id > 0) {
+        g_signal_handler_disconnect(window, handler_id);
       }
+
+      // Handle delete-event signal for window close button interception.
+      g_signal_connect(window, "delete-event", G_CALLBACK(delete_event), self);
+
+      // Make |window| background black, to prevent a white splash on launch.
+      g_autoptr(GtkCssProvider) style = gtk_css_provider_new();
+      gtk_css_provider_load_from_data(GTK_CSS_PROVIDER(style), "GtkLayout { background-color: transparent; } GtkViewport { background-color: transparent; }", -1, nullptr);
+      GdkScreen* screen = gtk_window_get_screen(window);
+      gtk_style_context_add_provider_for_screen(screen, GTK_STYLE_PROVIDER(style), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+      record_startup_phase(self, kStartupPhaseStyleLoaded);
     }
 
-    if (handler_id > 0) {
-      g_signal_handler_disconnect(window, handler_id);
-    }
-
-    // Handle delete-event signal for window close button interception.
-    g_signal_connect(window, "delete-event", G_CALLBACK(delete_event), self);
-
-    gint default_width = get_default_window_width(), default_height = get_default_window_height();
-    gtk_window_set_default_size(window, default_width, default_height);
-    GdkGeometry geometry;
-    geometry.base_width = default_width;
-    geometry.base_height = default_height;
-    gtk_window_set_geometry_hints(window, GTK_WIDGET(window), &geometry, static_cast<GdkWindowHints>(GDK_HINT_BASE_SIZE));
-    // Make |window| background black, to prevent a white splash on launch.
-    g_autoptr(GtkCssProvider) style = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(GTK_CSS_PROVIDER(style), "GtkLayout { background-color: transparent; } GtkViewport { background-color: transparent; }", -1, nullptr);
-    GdkScreen* screen = gtk_window_get_screen(window);
-    gtk_style_context_add_provider_for_screen(screen, GTK_STYLE_PROVIDER(style), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-    try {
-      FlValue* saved_window_state = fl_value_lookup_string(arguments, "savedWindowState");
-      if (fl_value_get_type(saved_window_state) == FL_VALUE_TYPE_MAP) {
-        gint x = fl_value_get_int(fl_value_lookup_string(saved_window_state, "x"));
-        gint y = fl_value_get_int(fl_value_lookup_string(saved_window_state, "y"));
-        gint width = fl_value_get_int(fl_value_lookup_string(saved_window_state, "width"));
-        gint height = fl_value_get_int(fl_value_lookup_string(saved_window_state, "height"));
-        gint maximized = fl_value_get_bool(fl_value_lookup_string(saved_window_state, "maximized"));
-        // Make the sure that |window| is present within bounds of any of the monitors.
-        // Otherwise, center the |window| to the closest monitor (to the mouse cursor).
-        // If the saved window dimensions exceed the monitor's |workarea|, then clamp to default window dimensions.
-        // If the |window| is present within bounds of any of the monitor(s), then restore the |window| to the saved position & size.
-        gboolean is_within_monitor = FALSE;
-        GdkDisplay* display = gdk_display_get_default();
-        gint n_monitors = gdk_display_get_n_monitors(display);
-        for (gint i = 0; i < n_monitors; i++) {
-          GdkMonitor* monitor = gdk_display_get_monitor(display, i);
-          GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-          gdk_monitor_get_workarea(monitor, &workarea);
-          gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-          if (success) {
-            g_print("GdkRectangle{ %d, %d, %d, %d }\n", workarea.x, workarea.y, workarea.width, workarea.height);
-            if (!is_within_monitor) {
-              gint monitor_left = workarea.x, monitor_top = workarea.y, monitor_right = workarea.x + workarea.width, monitor_bottom = workarea.y + workarea.height;
-              monitor_left += kMonitorSafeArea;
-              monitor_top += kMonitorSafeArea;
-              monitor_right -= kMonitorSafeArea;
-              monitor_bottom -= kMonitorSafeArea;
-              if (x > monitor_left && x + width < monitor_right && y > monitor_top && y + height < monitor_bottom) {
-                g_print("GtkWindow within bounds.\n");
-                is_within_monitor = TRUE;
-              }
-            }
-          }
-        }
-        if (is_within_monitor) {
-          gtk_window_resize(window, width, height);
-          gtk_window_move(window, x, y);
-        } else {
-          // Not present within bounds, center with the already saved & available |height| & |width| values.
-          GdkPoint cursor = get_cursor_position();
-          GdkDisplay* display = gdk_display_get_default();
-          GdkMonitor* monitor = gdk_display_get_monitor_at_point(display, cursor.x, cursor.y);
-          GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-          gdk_monitor_get_workarea(monitor, &workarea);
-          gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-          if (success) {
-            gtk_window_resize(window, default_width, default_height);
-            gtk_window_set_position(window, GTK_WIN_POS_CENTER);
-          }
+    // The saved window state is already restored if |window_plus_plugin_set_application| was called before registration. Otherwise,
+    // read it now using the |application| identifier sent from Dart.
+    if (!self->placement_restored) {
+      FlValue* application = fl_value_lookup_string(arguments, "application");
+      if (application != nullptr && fl_value_get_type(application) == FL_VALUE_TYPE_STRING) {
+        load_saved_window_state(self, fl_value_get_string(application));
+        if (self == plugin) {
+          start_single_instance_server(self, fl_value_get_string(application));
         }
-        // Maximize the |window| if it was maximized when it was closed.
-        if (maximized) {
-          gtk_window_maximize(window);
-        }
-      } else {
-        // No saved state. Restore window to the center of the workarea.
-        // Not present within bounds, center with the already saved & available |height| & |width| values.
-        GdkPoint cursor = get_cursor_position();
-        GdkDisplay* display = gdk_display_get_default();
-        GdkMonitor* monitor = gdk_display_get_monitor_at_point(display, cursor.x, cursor.y);
-        GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-        gdk_monitor_get_workarea(monitor, &workarea);
-        gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-        if (success) {
-          gtk_window_resize(window, default_width, default_height);
-          gtk_window_set_position(window, GTK_WIN_POS_CENTER);
-        }
-      }
-    } catch (...) {
-      // No saved state. Restore window to the center of the workarea.
-      // Not present within bounds, center with the already saved & available |height| & |width| values.
-      GdkPoint cursor = get_cursor_position();
-      GdkDisplay* display = gdk_display_get_default();
-      GdkMonitor* monitor = gdk_display_get_monitor_at_point(display, cursor.x, cursor.y);
-      GdkRectangle workarea = GdkRectangle{0, 0, 0, 0};
-      gdk_monitor_get_workarea(monitor, &workarea);
-      gboolean success = !(workarea.x == 0 && workarea.y == 0 && workarea.width == 0 && workarea.height == 0);
-      if (success) {
-        // Make sure to clamp ignore |width| & |height| if they exceed the current workarea dimensions and use default dimensions instead.
-        gtk_window_resize(window, default_width, default_height);
-        gtk_window_set_position(window, GTK_WIN_POS_CENTER);
       }
+      restore_window_placement(self, window);
     }
-    int64_t result = reinterpret_cast<int64_t>(window);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_int(result)));
+    update_state_snapshot(self);
+    record_startup_phase(self, kStartupPhaseEnsureInitializedCompleted);
+    g_autoptr(FlValue) result = fl_value_new_int(reinterpret_cast<int64_t>(window));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kSetMinimumSizeMethodName) == 0) {
     FlValue* arguments = fl_method_call_get_args(method_call);
     gint width = (gint)fl_value_get_float(fl_value_lookup_string(arguments, "width"));
     gint height = (gint)fl_value_get_float(fl_value_lookup_string(arguments, "height"));
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWidget* window = GTK_WIDGET(gtk_widget_get_toplevel(view));
+    GtkWidget* window = GTK_WIDGET(get_window(self));
     gtk_widget_set_size_request(window, width, height);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    update_state_snapshot(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kGetMinimumSizeMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWidget* window = GTK_WIDGET(gtk_widget_get_toplevel(view));
+    GtkWidget* window = GTK_WIDGET(get_window(self));
     gint width = 0, height = 0;
     gtk_widget_get_size_request(window, &width, &height);
-    FlValue* result = fl_value_new_map();
+    g_autoptr(FlValue) result = fl_value_new_map();
     fl_value_set_string_take(result, "width", fl_value_new_float((gdouble)width));
     fl_value_set_string_take(result, "height", fl_value_new_float((gdouble)height));
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kNotifyFirstFrameRasterizedMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    record_startup_phase(self, kStartupPhaseFirstFrameRasterized);
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    // Size of the first frame, the later ones are reported through |kNotifyFrameRasterizedMethodName| when the size changes.
+    lookup_int(arguments, "width", &self->frame_width);
+    lookup_int(arguments, "height", &self->frame_height);
+    GtkWidget* view = self->view;
+    GtkWindow* window = get_window(self);
+    hide_window_snapshot(self);
     // Show the Flutter |view| & |window|.
     gtk_widget_show(GTK_WIDGET(view));
     gtk_widget_show(GTK_WIDGET(window));
     // Capture user focus & present the |window| on top of other windows.
     gtk_window_present(window);
     gtk_widget_grab_focus(view);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    if (self->startup_profile[kStartupPhasePresented] == 0) {
+      record_startup_phase(self, kStartupPhasePresented);
+      dump_startup_profile(self);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kGetStateMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
     GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
     GdkWindowState state = gdk_window_get_state(gdk_window);
     gint x = -1, y = -1, width = -1, height = -1;
@@ -310,19 +2183,19 @@ static void window_plus_plugin_handle_method_call(WindowPlusPlugin* self, FlMeth
       // Current |window| position & size.
       gtk_window_get_position(window, &x, &y);
       gtk_window_get_size(window, &width, &height);
-    } else {
-      // Already cached |window| position & size, sent from Dart side.
-      FlValue* arguments = fl_method_call_get_args(method_call);
-      FlValue* saved_window_state = fl_value_lookup_string(arguments, "savedWindowState");
-      if (fl_value_get_type(saved_window_state) == FL_VALUE_TYPE_MAP) {
-        x = fl_value_get_int(fl_value_lookup_string(saved_window_state, "x"));
-        y = fl_value_get_int(fl_value_lookup_string(saved_window_state, "y"));
-        width = fl_value_get_int(fl_value_lookup_string(saved_window_state, "width"));
-        height = fl_value_get_int(fl_value_lookup_string(saved_window_state, "height"));
-      }
+      // Keep the native copy in sync with what Dart is about to write to |kWindowStateFileName|.
+      self->saved_state.rect = window_plus::PlacementRect{x, y, width, height};
+      self->has_saved_state = TRUE;
+    } else if (self->has_saved_state) {
+      // Already cached |window| position & size, read from |kWindowStateFileName| or the last call.
+      x = self->saved_state.rect.x;
+      y = self->saved_state.rect.y;
+      width = self->saved_state.rect.width;
+      height = self->saved_state.rect.height;
     }
-    auto result = fl_value_new_map();
-    // NOTE: Use existing cached |x|, |y|, |width| & |height| values if |maximized| is TRUE i.e. sent from Dart side.
+    self->saved_state.maximized = maximized;
+    g_autoptr(FlValue) result = fl_value_new_map();
+    // NOTE: Use existing cached |x|, |y|, |width| & |height| values if |maximized| is TRUE.
     fl_value_set_string_take(result, "x", fl_value_new_int(x));
     fl_value_set_string_take(result, "y", fl_value_new_int(y));
     fl_value_set_string_take(result, "width", fl_value_new_int(width));
@@ -330,166 +2203,473 @@ static void window_plus_plugin_handle_method_call(WindowPlusPlugin* self, FlMeth
     fl_value_set_string_take(result, "maximized", fl_value_new_bool(maximized));
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kCloseMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
     gtk_window_close(window);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kDestroyMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
-    g_application_quit(G_APPLICATION(gtk_window_get_application(window)));
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    GtkWindow* window = get_window(self);
+    // Persist the window state natively, Dart does not need to save it before the window is destroyed.
+    flush_window_state(self);
+    // The close is confirmed, capture the snapshot now. The window is hidden right away & destroyed once it is written.
+    g_object_ref(window);
+    if (save_window_snapshot(self, window_snapshot_saved_cb, window)) {
+      gtk_widget_hide(GTK_WIDGET(window));
+    } else {
+      destroy_window(window);
+      g_object_unref(window);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kGetIsMinimizedMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GdkWindow* window = gtk_widget_get_window(gtk_widget_get_toplevel(view));
+    GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(get_window(self)));
     GdkWindowState state = gdk_window_get_state(window);
     g_autoptr(FlValue) result = fl_value_new_bool(state & GDK_WINDOW_STATE_ICONIFIED);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kGetIsMaximizedMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GdkWindow* window = gtk_widget_get_window(gtk_widget_get_toplevel(view));
+    GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(get_window(self)));
     GdkWindowState state = gdk_window_get_state(window);
     g_autoptr(FlValue) result = fl_value_new_bool(state & GDK_WINDOW_STATE_MAXIMIZED);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kGetIsFullscreenMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GdkWindow* window = gtk_widget_get_window(gtk_widget_get_toplevel(view));
+    GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(get_window(self)));
     GdkWindowState state = gdk_window_get_state(window);
     g_autoptr(FlValue) result = fl_value_new_bool(state & GDK_WINDOW_STATE_FULLSCREEN);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kGetSizeMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
     gint width = 0, height = 0;
     gtk_window_get_size(window, &width, &height);
-    auto result = fl_value_new_map();
+    g_autoptr(FlValue) result = fl_value_new_map();
     fl_value_set_string_take(result, "left", fl_value_new_int(0));
     fl_value_set_string_take(result, "top", fl_value_new_int(0));
     fl_value_set_string_take(result, "width", fl_value_new_int(width));
     fl_value_set_string_take(result, "height", fl_value_new_int(height));
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kGetPositionMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
     gint dx = 0, dy = 0;
     gtk_window_get_position(window, &dx, &dy);
-    auto result = fl_value_new_map();
+    g_autoptr(FlValue) result = fl_value_new_map();
     fl_value_set_string_take(result, "dx", fl_value_new_int(dx));
     fl_value_set_string_take(result, "dy", fl_value_new_int(dy));
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, kGetMonitorsMethodName) == 0) {
-    g_autoptr(FlValue) result = fl_value_new_list();
-    GdkDisplay* display = gdk_display_get_default();
-    gint n_monitors = gdk_display_get_n_monitors(display);
-    for (gint i = 0; i < n_monitors; i++) {
-      GdkMonitor* monitor = gdk_display_get_monitor(display, i);
-      GdkRectangle workarea, bounds;
-      gdk_monitor_get_workarea(monitor, &workarea);
-      gdk_monitor_get_geometry(monitor, &bounds);
-
-      auto fl_monitor = fl_value_new_map();
-
-      FlValue* fl_workarea = fl_value_new_map();
-      fl_value_set_string_take(fl_workarea, "left", fl_value_new_int(workarea.x));
-      fl_value_set_string_take(fl_workarea, "top", fl_value_new_int(workarea.y));
-      fl_value_set_string_take(fl_workarea, "width", fl_value_new_int(workarea.width));
-      fl_value_set_string_take(fl_workarea, "height", fl_value_new_int(workarea.height));
-
-      FlValue* fl_bounds = fl_value_new_map();
-      fl_value_set_string_take(fl_bounds, "left", fl_value_new_int(bounds.x));
-      fl_value_set_string_take(fl_bounds, "top", fl_value_new_int(bounds.y));
-      fl_value_set_string_take(fl_bounds, "width", fl_value_new_int(bounds.width));
-      fl_value_set_string_take(fl_bounds, "height", fl_value_new_int(bounds.height));
-
-      fl_value_set_string_take(fl_monitor, "workarea", fl_workarea);
-      fl_value_set_string_take(fl_monitor, "bounds", fl_bounds);
-
-      fl_value_append_take(result, fl_monitor);
-    }
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    // Served from the cache, see |update_monitors|.
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(self->monitors_value));
   } else if (strcmp(method, kSetIsFullscreenMethodName) == 0) {
     FlValue* arguments = fl_method_call_get_args(method_call);
     bool enabled = fl_value_get_bool(fl_value_lookup_string(arguments, "enabled"));
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     if (enabled) {
       gtk_window_fullscreen(window);
     } else {
       gtk_window_unfullscreen(window);
     }
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    update_state_snapshot(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kMaximizeMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     gtk_window_maximize(window);
+    update_state_snapshot(self);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kRestoreMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     gtk_window_unmaximize(window);
+    update_state_snapshot(self);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kMinimizeMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     gtk_window_iconify(window);
+    update_state_snapshot(self);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kMoveMethodName) == 0) {
     FlValue* arguments = fl_method_call_get_args(method_call);
     gint x = fl_value_get_int(fl_value_lookup_string(arguments, "x"));
     gint y = fl_value_get_int(fl_value_lookup_string(arguments, "y"));
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     gtk_window_move(window, x, y);
+    GdkPoint requested = GdkPoint{x, y};
+    update_state_snapshot(self, &requested);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kResizeMethodName) == 0) {
     FlValue* arguments = fl_method_call_get_args(method_call);
     gint width = fl_value_get_int(fl_value_lookup_string(arguments, "width"));
     gint height = fl_value_get_int(fl_value_lookup_string(arguments, "height"));
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWindow* window = GTK_WINDOW(gtk_widget_get_toplevel(view));
+    GtkWindow* window = get_window(self);
+    suppress_live_operation_detection(self);
     gtk_window_resize(window, width, height);
+    GtkRequisition requested = GtkRequisition{width, height};
+    update_state_snapshot(self, nullptr, &requested);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kHideMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWidget* window = gtk_widget_get_toplevel(view);
+    GtkWidget* window = GTK_WIDGET(get_window(self));
     gtk_widget_hide(window);
+    update_state_snapshot(self);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else if (strcmp(method, kShowMethodName) == 0) {
-    GtkWidget* view = GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar));
-    GtkWidget* window = gtk_widget_get_toplevel(view);
+    GtkWidget* window = GTK_WIDGET(get_window(self));
     gtk_widget_show(window);
+    update_state_snapshot(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kApplyWindowTransactionMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    GtkWindow* window = get_window(self);
+    WindowTransaction transaction = window_transaction_from_value(arguments);
+    apply_window_transaction(self, window, &transaction);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kGetSavedWindowStateMethodName) == 0) {
+    g_autoptr(FlValue) result = saved_window_state_to_value(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, kSubscribeEventsMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    subscribe_events(self, fl_value_get_int(fl_value_lookup_string(arguments, "type")));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kUnsubscribeEventsMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    unsubscribe_events(self, fl_value_get_int(fl_value_lookup_string(arguments, "type")));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kSetCaptionRegionsMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    update_caption_regions(self, fl_value_lookup_string(arguments, "regions"), fl_value_lookup_string(arguments, "removed"));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kGetStartupProfileMethodName) == 0) {
+    g_autoptr(FlValue) result = startup_profile_to_value(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, kNotifyFrameBuiltMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    gint width = 0, height = 0;
+    if (lookup_int(arguments, "width", &width) && lookup_int(arguments, "height", &height)) {
+      notify_frame_built(self, width, height);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kNotifyFrameRasterizedMethodName) == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    gint width = 0, height = 0;
+    if (lookup_int(arguments, "width", &width) && lookup_int(arguments, "height", &height)) {
+      FlValue* raster_finish = fl_value_lookup_string(arguments, "rasterFinish");
+      notify_frame_rasterized(self, width, height,
+                              raster_finish != nullptr && fl_value_get_type(raster_finish) == FL_VALUE_TYPE_INT ? fl_value_get_int(raster_finish) : 0);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kGetMismatchedResizeFrameCountMethodName) == 0) {
+    g_autoptr(FlValue) result = fl_value_new_int(self->mismatched_resize_frame_count);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, kGetDroppedEventCountMethodName) == 0) {
+    g_autoptr(FlValue) result = fl_value_new_int(self->dropped_event_count);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else {
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
   }
   fl_method_call_respond(method_call, response, nullptr);
 }
 
-static void window_plus_plugin_dispose(GObject* object) { G_OBJECT_CLASS(window_plus_plugin_parent_class)->dispose(object); }
+static void window_plus_plugin_dispose(GObject* object) {
+  WindowPlusPlugin* self = WINDOW_PLUS_PLUGIN(object);
+  // Drop the pending (coalesced) configure-event.
+  cancel_pending_configure_event(self);
+  if (self->window != nullptr) {
+    g_object_weak_unref(G_OBJECT(self->window), window_weak_notify, self);
+    self->window = nullptr;
+  }
+  G_LOCK(windows);
+  if (self->id != 0 && windows != nullptr && g_hash_table_lookup(windows, &self->id) == self) {
+    g_hash_table_remove(windows, &self->id);
+  }
+  G_UNLOCK(windows);
+  if (plugin == self) {
+    plugin = nullptr;
+  }
+  if (self->channel != nullptr) {
+    // Releases the reference held by the method call handler.
+    fl_method_channel_set_method_call_handler(self->channel, nullptr, nullptr, nullptr);
+    g_clear_object(&self->channel);
+  }
+  g_clear_object(&self->event_channel);
+  g_clear_object(&self->lifecycle_channel);
+  if (self->monitors_source_id > 0) {
+    g_source_remove(self->monitors_source_id);
+    self->monitors_source_id = 0;
+  }
+  if (self->display != nullptr) {
+    g_signal_handlers_disconnect_by_data(self->display, self);
+    g_clear_object(&self->display);
+  }
+  if (self->monitors != nullptr) {
+    for (guint i = 0; i < self->monitors->len; i++) {
+      MonitorInfo* info = &g_array_index(self->monitors, MonitorInfo, i);
+      g_signal_handlers_disconnect_by_data(info->monitor, self);
+      g_object_unref(info->monitor);
+    }
+    g_clear_pointer(&self->monitors, g_array_unref);
+  }
+  g_clear_pointer(&self->monitors_value, fl_value_unref);
+  if (self->save_source_id > 0) {
+    g_source_remove(self->save_source_id);
+    self->save_source_id = 0;
+  }
+  g_clear_pointer(&self->state_file_path, g_free);
+  if (self->live_operation_source_id > 0) {
+    g_source_remove(self->live_operation_source_id);
+    self->live_operation_source_id = 0;
+  }
+  hide_window_snapshot(self);
+  end_resize_sync(self);
+  if (self->frame_clock != nullptr) {
+    g_signal_handler_disconnect(self->frame_clock, self->frame_clock_handler_id);
+    g_clear_object(&self->frame_clock);
+  }
+  g_clear_object(&self->caption_gesture);
+  g_clear_object(&self->frame_motion_controller);
+  g_clear_pointer(&self->caption_regions, g_array_unref);
+  if (self->single_instance_service != nullptr) {
+    g_signal_handlers_disconnect_by_data(self->single_instance_service, self);
+    g_socket_service_stop(self->single_instance_service);
+    g_socket_listener_close(G_SOCKET_LISTENER(self->single_instance_service));
+    g_clear_object(&self->single_instance_service);
+  }
+  if (self->launches_source_id > 0) {
+    g_source_remove(self->launches_source_id);
+    self->launches_source_id = 0;
+  }
+  g_clear_pointer(&self->pending_launches, fl_value_unref);
+  g_clear_pointer(&self->pending_startup_id, g_free);
+  G_OBJECT_CLASS(window_plus_plugin_parent_class)->dispose(object);
+}
 
 static void window_plus_plugin_class_init(WindowPlusPluginClass* klass) { G_OBJECT_CLASS(klass)->dispose = window_plus_plugin_dispose; }
 
-static void window_plus_plugin_init(WindowPlusPlugin* self) {}
+static void window_plus_plugin_init(WindowPlusPlugin* self) {
+  self->view = nullptr;
+  self->window = nullptr;
+  self->id = 0;
+  self->enable_event_streams = FALSE;
+  self->initialized = FALSE;
+  self->obscured = FALSE;
+  self->occluded = FALSE;
+  self->pause_when_occluded = FALSE;
+  self->lifecycle_channel = nullptr;
+  self->window_state_event_subscriptions = 0;
+  self->window_state_event_handler_id = 0;
+  self->configure_event_subscriptions = 0;
+  self->configure_event_handler_id = 0;
+  self->live_operation_event_subscriptions = 0;
+  self->frame_timing_event_subscriptions = 0;
+  self->frame_clock = nullptr;
+  self->frame_clock_handler_id = 0;
+  self->frame_timing_monitor = -1;
+  self->live_operation = kLiveOperationNone;
+  self->live_operation_source_id = 0;
+  self->last_geometry = GdkRectangle{0, 0, 0, 0};
+  self->last_geometry_time = 0;
+  self->live_operation_suppressed_until = 0;
+  self->caption_regions = g_array_new(FALSE, TRUE, sizeof(CaptionRegion));
+  self->caption_gesture = nullptr;
+  self->last_caption_press_time = 0;
+  self->custom_frame = FALSE;
+  self->resize_edges = 0;
+  self->frame_motion_controller = nullptr;
+  self->display = nullptr;
+  self->monitors = g_array_new(FALSE, TRUE, sizeof(MonitorInfo));
+  self->monitors_value = nullptr;
+  self->monitors_source_id = 0;
+  self->event_sequence = 0;
+  self->event_coalescing = kEventCoalescingNone;
+  self->event_coalescing_rate = kEventCoalescingDefaultRate;
+  self->configure_event_tick_id = 0;
+  self->configure_event_source_id = 0;
+  self->last_configure_event_time = 0;
+  self->configure_event_time = 0;
+  self->dropped_event_count = 0;
+  self->resize_sync_enabled = FALSE;
+  self->resize_sync_frozen = FALSE;
+  self->resize_sync_source_id = 0;
+  self->resize_sync_width = 0;
+  self->resize_sync_height = 0;
+  self->frame_width = 0;
+  self->frame_height = 0;
+  self->mismatched_resize_frame_count = 0;
+  self->resize_sync_thaw_time = 0;
+  self->resize_sync_thawed_width = 0;
+  self->resize_sync_thawed_height = 0;
+  self->last_sent_state = -1;
+  self->snapshot = WindowPlusStateSnapshot{};
+  self->snapshot.monitor = -1;
+  self->snapshot.scale_factor = 1.0;
+  self->has_saved_state = FALSE;
+  self->saved_state = window_plus::PlacementState{};
+  self->placement_restored = FALSE;
+  self->state_file_path = nullptr;
+  self->save_source_id = 0;
+  self->last_state_change_time = 0;
+  self->snapshot_file = nullptr;
+  self->snapshot_surface = nullptr;
+  self->snapshot_draw_handler_id = 0;
+  self->snapshot_source_id = 0;
+  self->single_instance_service = nullptr;
+  self->pending_launches = fl_value_new_list();
+  self->launches_source_id = 0;
+  self->pending_present = FALSE;
+  self->pending_startup_id = nullptr;
+  for (gint i = 0; i < kStartupPhaseCount; i++) {
+    self->startup_profile[i] = 0;
+  }
+}
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call, gpointer user_data) {
   WindowPlusPlugin* plugin = WINDOW_PLUS_PLUGIN(user_data);
   window_plus_plugin_handle_method_call(plugin, method_call);
 }
 
-void window_plus_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
-  plugin = WINDOW_PLUS_PLUGIN(g_object_new(window_plus_plugin_get_type(), nullptr));
-  plugin->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+WindowPlusPlugin* window_plus_plugin_new(FlBinaryMessenger* messenger, GtkWidget* view) {
+  G_LOCK(windows);
+  if (windows == nullptr) {
+    windows = g_hash_table_new(g_int64_hash, g_int64_equal);
+  }
+  G_UNLOCK(windows);
+  WindowPlusPlugin* self = WINDOW_PLUS_PLUGIN(g_object_new(window_plus_plugin_get_type(), nullptr));
+  record_startup_phase(self, kStartupPhaseRegisterWithRegistrar);
+  gboolean primary = plugin == nullptr;
+  if (primary) {
+    plugin = self;
+  }
+  self->view = view;
   g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
-  plugin->channel = fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar), kMethodChannelName, FL_METHOD_CODEC(codec));
-  fl_method_channel_set_method_call_handler(plugin->channel, method_call_cb, plugin, g_object_unref);
+  self->channel = fl_method_channel_new(messenger, kMethodChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, self, g_object_unref);
+  g_autoptr(FlBinaryCodec) event_codec = fl_binary_codec_new();
+  self->event_channel = fl_basic_message_channel_new(messenger, kEventChannelName, FL_MESSAGE_CODEC(event_codec));
+  g_autoptr(FlStringCodec) lifecycle_codec = fl_string_codec_new();
+  self->lifecycle_channel = fl_basic_message_channel_new(messenger, kLifecycleChannelName, FL_MESSAGE_CODEC(lifecycle_codec));
+  // Build the monitor table once & keep it up to date.
+  self->display = GDK_DISPLAY(g_object_ref(gdk_display_get_default()));
+  g_signal_connect(self->display, "monitor-added", G_CALLBACK(monitor_added_cb), self);
+  g_signal_connect(self->display, "monitor-removed", G_CALLBACK(monitor_removed_cb), self);
+  update_monitors(self);
+  record_startup_phase(self, kStartupPhaseMonitorsCached);
+  // Restore the saved window state right away i.e. before |fl_register_plugins| returns & the Dart VM starts, if possible.
+  // |application_id| only refers to the main window, other windows are restored from |kEnsureInitializedMethodName|.
+  GtkWindow* window = get_window(self);
+  if (primary && application_id != nullptr && window != nullptr) {
+    load_saved_window_state(self, application_id);
+    restore_window_placement(self, window);
+    show_window_snapshot(self, window);
+  }
+  if (primary && application_id != nullptr) {
+    start_single_instance_server(self, application_id);
+  }
+  record_startup_phase(self, kStartupPhaseRegistered);
+  return self;
+}
+
+gboolean window_plus_plugin_hit_test_caption_regions(WindowPlusPlugin* plugin, gint x, gint y) { return hit_test_caption_regions(plugin, x, y); }
+
+gint window_plus_plugin_get_resize_edges(WindowPlusPlugin* plugin, gdouble x, gdouble y) { return get_resize_edges(plugin, get_window(plugin), x, y); }
+
+void window_plus_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  WindowPlusPlugin* self = window_plus_plugin_new(fl_plugin_registrar_get_messenger(registrar), GTK_WIDGET(fl_plugin_registrar_get_view(registrar)));
+  self->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+}
+
+void window_plus_plugin_set_application(const gchar* application) {
+  g_free(application_id);
+  application_id = g_strdup(application);
 }
 
 void window_plus_plugin_handle_single_instance(gchar** arguments) {
   if (plugin) {
-    g_autoptr(FlValue) result = fl_value_new_list();
-    for (gint i = 0; i < g_strv_length(arguments); i++) {
-      fl_value_append_take(result, fl_value_new_string(arguments[i]));
+    queue_single_instance_launch(plugin, single_instance_launch_to_value(nullptr, arguments, nullptr));
+  }
+}
+
+gboolean window_plus_plugin_send_single_instance_arguments(const gchar* application, gchar** arguments) {
+  g_autofree gchar* name = get_single_instance_socket_name(application);
+  g_autoptr(GSocketAddress) address = g_unix_socket_address_new_with_type(name, -1, G_UNIX_SOCKET_ADDRESS_ABSTRACT);
+  g_autoptr(GSocketClient) client = g_socket_client_new();
+  g_autoptr(GSocketConnection) connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(address), nullptr, nullptr);
+  if (connection == nullptr) {
+    // No primary instance is running.
+    return FALSE;
+  }
+  // Abstract sockets are not protected by file-system permissions i.e. any local user can bind the name first. Never hand the arguments
+  // & startup hints over to a server run by another user, start as the primary instance instead.
+  g_autoptr(GCredentials) credentials = g_socket_get_credentials(g_socket_connection_get_socket(connection), nullptr);
+  if (credentials == nullptr || g_credentials_get_unix_user(credentials, nullptr) != getuid()) {
+    g_warning("Ignoring single instance socket %s, not owned by the current user.", name);
+    return FALSE;
+  }
+  g_autofree gchar* working_directory = g_get_current_dir();
+  GVariantBuilder environment;
+  g_variant_builder_init(&environment, G_VARIANT_TYPE("a{ss}"));
+  for (auto hint : kSingleInstanceEnvironmentHints) {
+    const gchar* value = g_getenv(hint);
+    if (value != nullptr) {
+      g_variant_builder_add(&environment, "{ss}", hint, value);
+    }
+  }
+  const gchar* const empty[] = {nullptr};
+  g_autoptr(GVariant) message = g_variant_ref_sink(g_variant_new("(s@as@a{ss})", working_directory, g_variant_new_strv(arguments != nullptr ? const_cast<const gchar* const*>(arguments) : empty, -1),
+                                                                 g_variant_builder_end(&environment)));
+  if (g_variant_get_size(message) > kSingleInstanceMaximumMessageSize) {
+    g_warning("Single instance message of %" G_GSIZE_FORMAT " bytes is too large.", g_variant_get_size(message));
+    return FALSE;
+  }
+  guint32 size = GUINT32_TO_LE(static_cast<guint32>(g_variant_get_size(message)));
+  GOutputStream* output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+  gboolean result = g_output_stream_write_all(output, &size, sizeof(size), nullptr, nullptr, nullptr) &&
+                    g_output_stream_write_all(output, g_variant_get_data(message), g_variant_get_size(message), nullptr, nullptr, nullptr);
+  g_io_stream_close(G_IO_STREAM(connection), nullptr, nullptr);
+  return result;
+}
+
+void window_plus_plugin_ensure_single_instance(const gchar* application, gint argc, gchar** argv) {
+  // Strip out the first argument as it is the binary name.
+  if (argc > 0 && window_plus_plugin_send_single_instance_arguments(application, argv + 1)) {
+    exit(EXIT_SUCCESS);
+  }
+}
+
+gint64 window_plus_plugin_get_monotonic_time() { return g_get_monotonic_time(); }
+
+// Returns the instance of the window with |window_id|, NULL if none. The caller holds the |windows| lock.
+static WindowPlusPlugin* lookup_window_locked(gint64 window_id) {
+  return windows != nullptr ? static_cast<WindowPlusPlugin*>(g_hash_table_lookup(windows, &window_id)) : nullptr;
+}
+
+gboolean window_plus_plugin_copy_state_snapshot_for_window(gint64 window_id, WindowPlusStateSnapshot* result) {
+  // Held for the whole copy, the instance cannot be disposed (& freed) meanwhile.
+  G_LOCK(windows);
+  WindowPlusPlugin* instance = lookup_window_locked(window_id);
+  if (instance == nullptr) {
+    G_UNLOCK(windows);
+    return FALSE;
+  }
+  const WindowPlusStateSnapshot* snapshot = &instance->snapshot;
+  // Sequence lock (see |update_state_snapshot|): retry while |sequence| is odd or changes while the fields are copied. The acquire loads
+  // & fence keep the field loads between the two |sequence| loads, also on weakly ordered CPUs (e.g. aarch64).
+  while (true) {
+    guint32 sequence = __atomic_load_n(&snapshot->sequence, __ATOMIC_ACQUIRE);
+    if (sequence & 1) {
+      continue;
+    }
+    result->state = __atomic_load_n(&snapshot->state, __ATOMIC_RELAXED);
+    result->x = __atomic_load_n(&snapshot->x, __ATOMIC_RELAXED);
+    result->y = __atomic_load_n(&snapshot->y, __ATOMIC_RELAXED);
+    result->width = __atomic_load_n(&snapshot->width, __ATOMIC_RELAXED);
+    result->height = __atomic_load_n(&snapshot->height, __ATOMIC_RELAXED);
+    result->minimum_width = __atomic_load_n(&snapshot->minimum_width, __ATOMIC_RELAXED);
+    result->minimum_height = __atomic_load_n(&snapshot->minimum_height, __ATOMIC_RELAXED);
+    result->monitor = __atomic_load_n(&snapshot->monitor, __ATOMIC_RELAXED);
+    __atomic_load(&snapshot->scale_factor, &result->scale_factor, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&snapshot->sequence, __ATOMIC_RELAXED) == sequence) {
+      result->sequence = sequence;
+      result->reserved = 0;
+      G_UNLOCK(windows);
+      return TRUE;
     }
-    fl_method_channel_invoke_method(plugin->channel, kSingleInstanceDataReceivedMethodName, result, nullptr, nullptr, nullptr);
   }
 }
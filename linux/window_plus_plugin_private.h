@@ -6,5 +6,14 @@
 // https://github.com/flutter/flutter/issues/88724 for current limitations
 // in the unit-testable API.
 
-// Handles the getPlatformVersion method call.
-FlMethodResponse *get_platform_version();
+// Creates the plugin for |view| (already added to its GtkWindow) with its channels on |messenger|, same as
+// |window_plus_plugin_register_with_registrar| but without an FlPluginRegistrar. The instance is owned by its method channel;
+// |g_object_run_dispose| releases it.
+WindowPlusPlugin* window_plus_plugin_new(FlBinaryMessenger* messenger, GtkWidget* view);
+
+// Returns whether the |FlView| coordinates |x|, |y| start a window drag i.e. are within a caption region pushed with |setCaptionRegions| &
+// not within any of its no-drag regions.
+gboolean window_plus_plugin_hit_test_caption_regions(WindowPlusPlugin* plugin, gint x, gint y);
+
+// Returns the edges of the custom frame (left 1, right 2, top 4 & bottom 8) resizing the window from its coordinates |x|, |y|. 0 if none.
+gint window_plus_plugin_get_resize_edges(WindowPlusPlugin* plugin, gdouble x, gdouble y);
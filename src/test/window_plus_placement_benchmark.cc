@@ -0,0 +1,64 @@
+// This file is a part of window_plus (https://github.com/alexmercerind/window_plus).
+//
+// Copyright (c) 2022 & onwards, Hitesh Kumar Saini <saini123hitesh@gmail.com>.
+// All rights reserved. Use of this source code is governed by MIT license that can be found in the LICENSE file.
+#include "window_plus_placement.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace window_plus {
+namespace {
+
+// |count| monitors side by side, 1920x1080 each with a 40px panel at the top.
+std::vector<PlacementMonitor> GetMonitors(int32_t count) {
+  std::vector<PlacementMonitor> monitors;
+  for (int32_t i = 0; i < count; i++) {
+    PlacementMonitor monitor;
+    monitor.bounds = PlacementRect{i * 1920, 0, 1920, 1080};
+    monitor.workarea = PlacementRect{i * 1920, 40, 1920, 1040};
+    monitors.emplace_back(monitor);
+  }
+  return monitors;
+}
+
+// Saved rect within the last monitor i.e. the worst case of the restore path.
+void BM_RestoreSavedRect(benchmark::State& state) {
+  auto monitors = GetMonitors(static_cast<int32_t>(state.range(0)));
+  PlacementState saved;
+  saved.rect = PlacementRect{(static_cast<int32_t>(state.range(0)) - 1) * 1920 + 100, 100, 800, 600};
+  PlacementOptions options;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeWindowPlacement(monitors, &saved, options));
+  }
+}
+BENCHMARK(BM_RestoreSavedRect)->Arg(1)->Arg(4)->Arg(16);
+
+// Saved rect outside all the monitors, centered on the last one (under the cursor).
+void BM_CenterOffScreenRect(benchmark::State& state) {
+  auto monitors = GetMonitors(static_cast<int32_t>(state.range(0)));
+  PlacementState saved;
+  saved.rect = PlacementRect{-5000, -5000, 800, 600};
+  PlacementOptions options;
+  options.cursor_x = (static_cast<int32_t>(state.range(0)) - 1) * 1920 + 100;
+  options.cursor_y = 100;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeWindowPlacement(monitors, &saved, options));
+  }
+}
+BENCHMARK(BM_CenterOffScreenRect)->Arg(1)->Arg(4)->Arg(16);
+
+void BM_NoSavedState(benchmark::State& state) {
+  auto monitors = GetMonitors(static_cast<int32_t>(state.range(0)));
+  PlacementOptions options;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeWindowPlacement(monitors, nullptr, options));
+  }
+}
+BENCHMARK(BM_NoSavedState)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace
+}  // namespace window_plus
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+// This file is a part of window_plus (https://github.com/alexmercerind/window_plus).
+//
+// Copyright (c) 2022 & onwards, Hitesh Kumar Saini <saini123hitesh@gmail.com>.
+// All rights reserved. Use of this source code is governed by MIT license that can be found in the LICENSE file.
+#include "window_plus_placement.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace window_plus {
+namespace {
+
+// 1920x1080 monitor at the origin with a 40px panel at the top & a 1920x1080 monitor on its right without any panel.
+std::vector<PlacementMonitor> GetMonitors() {
+  PlacementMonitor primary;
+  primary.bounds = PlacementRect{0, 0, 1920, 1080};
+  primary.workarea = PlacementRect{0, 40, 1920, 1040};
+  PlacementMonitor secondary;
+  secondary.bounds = PlacementRect{1920, 0, 1920, 1080};
+  secondary.workarea = PlacementRect{1920, 0, 1920, 1080};
+  return {primary, secondary};
+}
+
+PlacementOptions GetOptions(int32_t cursor_x = 100, int32_t cursor_y = 100) {
+  PlacementOptions options;
+  options.safe_area = 8;
+  options.default_width = 1280;
+  options.default_height = 720;
+  options.cursor_x = cursor_x;
+  options.cursor_y = cursor_y;
+  return options;
+}
+
+void ExpectRect(const PlacementRect& actual, int32_t x, int32_t y, int32_t width, int32_t height) {
+  EXPECT_EQ(actual.x, x);
+  EXPECT_EQ(actual.y, y);
+  EXPECT_EQ(actual.width, width);
+  EXPECT_EQ(actual.height, height);
+}
+
+TEST(WindowPlusPlacementTest, RestoresSavedRectWithinMonitor) {
+  PlacementState saved;
+  saved.rect = PlacementRect{100, 200, 800, 600};
+  auto result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 100, 200, 800, 600);
+  EXPECT_FALSE(result.maximized);
+}
+
+TEST(WindowPlusPlacementTest, RestoresSavedRectWithinSecondMonitor) {
+  PlacementState saved;
+  saved.rect = PlacementRect{2000, 100, 800, 600};
+  // The cursor is on the first monitor, the saved rect is kept as it is.
+  auto result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 2000, 100, 800, 600);
+}
+
+TEST(WindowPlusPlacementTest, CarriesOverMaximizedState) {
+  PlacementState saved;
+  saved.rect = PlacementRect{100, 200, 800, 600};
+  saved.maximized = true;
+  EXPECT_TRUE(ComputeWindowPlacement(GetMonitors(), &saved, GetOptions()).maximized);
+  // Also when the saved rect is not restored.
+  saved.rect = PlacementRect{-5000, -5000, 800, 600};
+  EXPECT_TRUE(ComputeWindowPlacement(GetMonitors(), &saved, GetOptions()).maximized);
+}
+
+TEST(WindowPlusPlacementTest, SafeAreaEdges) {
+  auto monitor = GetMonitors()[0];
+  // Workarea is [0, 40] - [1920, 1080], the safe area leaves (8, 48) - (1912, 1072) exclusive.
+  EXPECT_TRUE(IsWithinMonitor(PlacementRect{9, 49, 1902, 1022}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{8, 49, 100, 100}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{9, 48, 100, 100}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{9, 49, 1903, 100}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{9, 49, 100, 1023}, monitor, 8));
+  // Without a safe area, only the workarea itself (still exclusive).
+  EXPECT_TRUE(IsWithinMonitor(PlacementRect{1, 41, 1918, 1038}, monitor, 0));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{0, 41, 100, 100}, monitor, 0));
+}
+
+TEST(WindowPlusPlacementTest, IgnoresMonitorWithoutWorkarea) {
+  PlacementMonitor monitor;
+  monitor.bounds = PlacementRect{0, 0, 1920, 1080};
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{100, 100, 100, 100}, monitor, 8));
+}
+
+TEST(WindowPlusPlacementTest, ScalesSafeArea) {
+  auto monitor = GetMonitors()[1];
+  monitor.scale_factor = 2.0;
+  // 16px safe area at 2x i.e. (1936, 16) - (3824, 1064) exclusive.
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{1930, 100, 100, 100}, monitor, 8));
+  EXPECT_TRUE(IsWithinMonitor(PlacementRect{1937, 17, 100, 100}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{1937, 16, 100, 100}, monitor, 8));
+  EXPECT_FALSE(IsWithinMonitor(PlacementRect{3700, 100, 124, 100}, monitor, 8));
+  // Same rect is within the monitor at 1x.
+  monitor.scale_factor = 1.0;
+  EXPECT_TRUE(IsWithinMonitor(PlacementRect{1930, 100, 100, 100}, monitor, 8));
+}
+
+TEST(WindowPlusPlacementTest, CentersOffScreenWindowOnCursorMonitorWithSavedSize) {
+  PlacementState saved;
+  saved.rect = PlacementRect{-5000, -5000, 800, 600};
+  auto result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 960 - 400, 40 + 520 - 300, 800, 600);
+  // Cursor on the second monitor.
+  result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions(2500, 500));
+  ExpectRect(result.rect, 1920 + 960 - 400, 540 - 300, 800, 600);
+}
+
+TEST(WindowPlusPlacementTest, CentersPartiallyVisibleWindow) {
+  PlacementState saved;
+  // Crosses the border of both the monitors, within neither.
+  saved.rect = PlacementRect{1800, 100, 800, 600};
+  auto result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 560, 260, 800, 600);
+}
+
+TEST(WindowPlusPlacementTest, UsesDefaultSizeForOversizedSavedSize) {
+  PlacementState saved;
+  saved.rect = PlacementRect{-10, -10, 2500, 1500};
+  auto result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 960 - 640, 40 + 520 - 360, 1280, 720);
+  // Only the dimension exceeding the workarea is replaced.
+  saved.rect = PlacementRect{-10, -10, 800, 1500};
+  result = ComputeWindowPlacement(GetMonitors(), &saved, GetOptions());
+  ExpectRect(result.rect, 960 - 400, 40 + 520 - 360, 800, 720);
+}
+
+TEST(WindowPlusPlacementTest, CentersWithDefaultSizeWithoutSavedState) {
+  auto result = ComputeWindowPlacement(GetMonitors(), nullptr, GetOptions(2500, 500));
+  ExpectRect(result.rect, 1920 + 960 - 640, 540 - 360, 1280, 720);
+  EXPECT_FALSE(result.maximized);
+}
+
+TEST(WindowPlusPlacementTest, FallsBackToFirstMonitorWithWorkarea) {
+  auto monitors = GetMonitors();
+  monitors[0].workarea = PlacementRect{};
+  // Cursor outside all the monitors, the first one has no workarea.
+  auto result = ComputeWindowPlacement(monitors, nullptr, GetOptions(-100, -100));
+  ExpectRect(result.rect, 1920 + 960 - 640, 540 - 360, 1280, 720);
+}
+
+TEST(WindowPlusPlacementTest, NoMonitors) {
+  std::vector<PlacementMonitor> monitors;
+  auto result = ComputeWindowPlacement(monitors, nullptr, GetOptions());
+  ExpectRect(result.rect, 0, 0, 1280, 720);
+  PlacementState saved;
+  saved.rect = PlacementRect{100, 200, 800, 600};
+  saved.maximized = true;
+  result = ComputeWindowPlacement(monitors, &saved, GetOptions());
+  ExpectRect(result.rect, 0, 0, 800, 600);
+  EXPECT_TRUE(result.maximized);
+}
+
+}  // namespace
+}  // namespace window_plus
@@ -0,0 +1,82 @@
+// This file is a part of window_plus (https://github.com/alexmercerind/window_plus).
+//
+// Copyright (c) 2022 & onwards, Hitesh Kumar Saini <saini123hitesh@gmail.com>.
+// All rights reserved. Use of this source code is governed by MIT license that can be found in the LICENSE file.
+#include "window_plus_placement.h"
+
+namespace window_plus {
+
+namespace {
+
+// Returns the monitor under the cursor, the first monitor with a valid workarea if the cursor is outside all of them.
+const PlacementMonitor* GetCursorMonitor(const std::vector<PlacementMonitor>& monitors, const PlacementOptions& options) {
+  const PlacementMonitor* result = nullptr;
+  for (const auto& monitor : monitors) {
+    if (monitor.workarea.IsEmpty()) {
+      continue;
+    }
+    if (result == nullptr) {
+      result = &monitor;
+    }
+    if (monitor.bounds.Contains(options.cursor_x, options.cursor_y)) {
+      return &monitor;
+    }
+  }
+  return result;
+}
+
+PlacementRect CenterInWorkarea(const PlacementRect& workarea, int32_t width, int32_t height) {
+  PlacementRect result;
+  result.width = width;
+  result.height = height;
+  result.x = workarea.x + workarea.width / 2 - width / 2;
+  result.y = workarea.y + workarea.height / 2 - height / 2;
+  return result;
+}
+
+}  // namespace
+
+bool IsWithinMonitor(const PlacementRect& rect, const PlacementMonitor& monitor, int32_t safe_area) {
+  if (monitor.workarea.IsEmpty()) {
+    return false;
+  }
+  auto scaled_safe_area = static_cast<int32_t>(safe_area * monitor.scale_factor);
+  auto left = monitor.workarea.x + scaled_safe_area;
+  auto top = monitor.workarea.y + scaled_safe_area;
+  auto right = monitor.workarea.x + monitor.workarea.width - scaled_safe_area;
+  auto bottom = monitor.workarea.y + monitor.workarea.height - scaled_safe_area;
+  return rect.x > left && rect.x + rect.width < right && rect.y > top && rect.y + rect.height < bottom;
+}
+
+PlacementState ComputeWindowPlacement(const std::vector<PlacementMonitor>& monitors, const PlacementState* saved, const PlacementOptions& options) {
+  auto result = PlacementState{};
+  if (saved != nullptr) {
+    result.maximized = saved->maximized;
+    for (const auto& monitor : monitors) {
+      if (IsWithinMonitor(saved->rect, monitor, options.safe_area)) {
+        result.rect = saved->rect;
+        return result;
+      }
+    }
+  }
+  auto width = options.default_width, height = options.default_height;
+  auto monitor = GetCursorMonitor(monitors, options);
+  if (monitor == nullptr) {
+    // No usable monitor information. Keep whatever is known about the size.
+    if (saved != nullptr) {
+      width = saved->rect.width;
+      height = saved->rect.height;
+    }
+    result.rect = PlacementRect{0, 0, width, height};
+    return result;
+  }
+  if (saved != nullptr) {
+    // Keep the saved size, unless it exceeds the workarea.
+    width = saved->rect.width > monitor->workarea.width ? options.default_width : saved->rect.width;
+    height = saved->rect.height > monitor->workarea.height ? options.default_height : saved->rect.height;
+  }
+  result.rect = CenterInWorkarea(monitor->workarea, width, height);
+  return result;
+}
+
+}  // namespace window_plus
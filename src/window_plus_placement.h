@@ -0,0 +1,62 @@
+// This file is a part of window_plus (https://github.com/alexmercerind/window_plus).
+//
+// Copyright (c) 2022 & onwards, Hitesh Kumar Saini <saini123hitesh@gmail.com>.
+// All rights reserved. Use of this source code is governed by MIT license that can be found in the LICENSE file.
+#ifndef WINDOW_PLUS_PLACEMENT_H_
+#define WINDOW_PLUS_PLACEMENT_H_
+
+#include <cstdint>
+#include <vector>
+
+// Window placement engine shared by the GNU/Linux & Windows plugins.
+// It has no dependency on Flutter, GTK or Win32, so that it can be built & used anywhere.
+
+namespace window_plus {
+
+struct PlacementRect {
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t width = 0;
+  int32_t height = 0;
+
+  bool IsEmpty() const { return x == 0 && y == 0 && width == 0 && height == 0; }
+
+  bool Contains(int32_t px, int32_t py) const { return px >= x && px < x + width && py >= y && py < y + height; }
+};
+
+struct PlacementMonitor {
+  PlacementRect bounds;
+  PlacementRect workarea;
+  // Scale applied to |PlacementOptions::safe_area|. Use 1.0 where coordinates are already logical (e.g. GTK).
+  double scale_factor = 1.0;
+};
+
+struct PlacementState {
+  PlacementRect rect;
+  bool maximized = false;
+};
+
+struct PlacementOptions {
+  // Margin (inside the workarea) the saved window must be within, to be restored at its saved position.
+  int32_t safe_area = 8;
+  int32_t default_width = 1280;
+  int32_t default_height = 720;
+  // Position of the mouse cursor. Used to pick the monitor to center the window on.
+  int32_t cursor_x = 0;
+  int32_t cursor_y = 0;
+};
+
+// Computes the final rect & state of the window from the available |monitors| & the |saved| state (may be nullptr), in one step:
+// * If the |saved| rect is present within the workarea (minus the safe area) of any of the |monitors|, it is restored as it is.
+// * Otherwise, the window is centered on the workarea of the monitor under the cursor. The saved size is kept, unless it exceeds the
+//   workarea, in which case the default size is used.
+// * Without any |saved| state, the window is centered on the workarea of the monitor under the cursor with the default size.
+// The |maximized| state is carried over from |saved|, so that the backend can apply everything at once, before the window is shown.
+PlacementState ComputeWindowPlacement(const std::vector<PlacementMonitor>& monitors, const PlacementState* saved, const PlacementOptions& options);
+
+// Returns true if |rect| is present within the workarea (minus the scaled safe area) of |monitor|.
+bool IsWithinMonitor(const PlacementRect& rect, const PlacementMonitor& monitor, int32_t safe_area);
+
+}  // namespace window_plus
+
+#endif  // WINDOW_PLUS_PLACEMENT_H_
@@ -11,6 +11,7 @@
 #include <flutter/standard_method_codec.h>
 
 #include "include/window_plus/window_plus_plugin_c_api.h"
+#include "window_plus_placement.h"
 
 namespace window_plus {
 
@@ -554,61 +555,52 @@ void WindowPlusPlugin::HandleMethodCall(const flutter::MethodCall<flutter::Encod
     // Send a |WM_NCCALCSIZE|.
     auto refresh = SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED;
     ::SetWindowPos(GetWindow(), nullptr, 0, 0, 0, 0, refresh);
+    // Restore the saved position & size if the window is within any of the available monitor rects, otherwise center it on the |monitor|
+    // where the cursor is present. The final rect is computed in one step using the shared placement engine & applied at once.
+    // The maximized state is applied when the window is shown, see |kNotifyFirstFrameRasterizedMethodName|.
+    auto to_placement_rect = [](const RECT& rect) {
+      return PlacementRect{static_cast<int32_t>(rect.left), static_cast<int32_t>(rect.top), static_cast<int32_t>(rect.right - rect.left), static_cast<int32_t>(rect.bottom - rect.top)};
+    };
+    auto placement_monitors = std::vector<PlacementMonitor>{};
+    for (auto monitor : GetMonitors()) {
+      MONITORINFO info;
+      info.cbSize = sizeof(MONITORINFO);
+      ::GetMonitorInfo(monitor, &info);
+      auto placement_monitor = PlacementMonitor{};
+      placement_monitor.bounds = to_placement_rect(info.rcMonitor);
+      placement_monitor.workarea = to_placement_rect(info.rcWork);
+      placement_monitor.scale_factor = FlutterDesktopGetDpiForMonitor(monitor) / kDefaultDPI;
+      placement_monitors.emplace_back(placement_monitor);
+    }
+    POINT cursor;
+    ::GetCursorPos(&cursor);
+    auto options = PlacementOptions{};
+    options.safe_area = kMonitorSafeArea;
+    options.default_width = default_width_;
+    options.default_height = default_height_;
+    options.cursor_x = static_cast<int32_t>(cursor.x);
+    options.cursor_y = static_cast<int32_t>(cursor.y);
+    auto saved = PlacementState{};
+    auto has_saved = false;
     try {
       auto saved_window_state = arguments[flutter::EncodableValue("savedWindowState")];
       if (auto value = std::get_if<flutter::EncodableMap>(&saved_window_state)) {
         auto data = *value;
-        auto x = std::get<int32_t>(data[flutter::EncodableValue("x")]);
-        auto y = std::get<int32_t>(data[flutter::EncodableValue("y")]);
-        auto width = std::get<int32_t>(data[flutter::EncodableValue("width")]);
-        auto height = std::get<int32_t>(data[flutter::EncodableValue("height")]);
-        // UNUSED:
-        // auto maximized =  std::get<bool>(data[flutter::EncodableValue("maximized")]);
-        // If the window is within any of the available monitor rects, then alright otherwise, restore it to that position.
-        // Otherwise, restore it to the center of the |monitor|.
-        auto is_within_monitor = false;
-        auto monitors = GetMonitors();
-        for (auto monitor : monitors) {
-          MONITORINFO info;
-          info.cbSize = sizeof(MONITORINFO);
-          ::GetMonitorInfo(monitor, &info);
-          std::cout << "RECT{ " << info.rcWork.left << ", " << info.rcWork.top << ", " << info.rcWork.right << ", " << info.rcWork.bottom << " }" << std::endl;
-          auto dpi = FlutterDesktopGetDpiForMonitor(monitor);
-          auto scale_factor = dpi / 96.0;
-          auto safe_area = static_cast<LONG>(kMonitorSafeArea * scale_factor);
-          info.rcWork.left += safe_area;
-          info.rcWork.top += safe_area;
-          info.rcWork.right -= safe_area;
-          info.rcWork.bottom -= safe_area;
-          if (!is_within_monitor) {
-            if (x > info.rcWork.left && x + width < info.rcWork.right && y > info.rcWork.top && y + height < info.rcWork.bottom) {
-              std::cout << "HWND within bounds." << std::endl;
-              is_within_monitor = true;
-            }
-          }
-        }
-        if (is_within_monitor) {
-          ::SetWindowPos(GetWindow(), nullptr, x, y, width, height, 0);
-        } else {
-          auto monitor = GetMonitorRect();
-          // If |width| or |height| exceeds the monitor size, then use the |default_width_| & |default_height_|.
-          width = width > (monitor.right - monitor.left) ? default_width_ : width;
-          height = height > (monitor.bottom - monitor.top) ? default_height_ : height;
-          ::SetWindowPos(GetWindow(), nullptr, monitor.left + (monitor.right - monitor.left) / 2 - width / 2, monitor.top + (monitor.bottom - monitor.top) / 2 - height / 2, width, height, 0);
+        saved.rect.x = std::get<int32_t>(data[flutter::EncodableValue("x")]);
+        saved.rect.y = std::get<int32_t>(data[flutter::EncodableValue("y")]);
+        saved.rect.width = std::get<int32_t>(data[flutter::EncodableValue("width")]);
+        saved.rect.height = std::get<int32_t>(data[flutter::EncodableValue("height")]);
+        if (auto maximized = std::get_if<bool>(&data[flutter::EncodableValue("maximized")])) {
+          saved.maximized = *maximized;
         }
-      } else {
-        // No saved window state, so restore the window to the center of the |monitor| where the cursor is present.
-        auto monitor = GetMonitorRect();
-        ::SetWindowPos(GetWindow(), nullptr, monitor.left + (monitor.right - monitor.left) / 2 - default_width_ / 2, monitor.top + (monitor.bottom - monitor.top) / 2 - default_height_ / 2,
-                       default_width_, default_height_, 0);
+        has_saved = true;
       }
     } catch (...) {
       // Typically, an instance of |std::bad_variant_access| will be received.
-      // No saved window state, so restore the window to the center of the |monitor| where the cursor is present.
-      auto monitor = GetMonitorRect();
-      ::SetWindowPos(GetWindow(), nullptr, monitor.left + (monitor.right - monitor.left) / 2 - default_width_ / 2, monitor.top + (monitor.bottom - monitor.top) / 2 - default_height_ / 2,
-                     default_width_, default_height_, 0);
+      has_saved = false;
     }
+    auto placement = ComputeWindowPlacement(placement_monitors, has_saved ? &saved : nullptr, options);
+    ::SetWindowPos(GetWindow(), nullptr, placement.rect.x, placement.rect.y, placement.rect.width, placement.rect.height, 0);
     result->Success(flutter::EncodableValue(reinterpret_cast<int64_t>(GetWindow())));
   } else if (method_call.method_name().compare(kNotifyFirstFrameRasterizedMethodName) == 0) {
     first_frame_rasterized_ = true;